@@ -1,11 +1,13 @@
 """Build script for nanoprintf. Configures and runs CMake to build tests."""
 
 import argparse
+import json
 import os
 import pathlib
 import shutil
 import subprocess
 import stat
+import statistics
 import sys
 import tarfile
 import urllib.request
@@ -13,6 +15,9 @@ import zipfile
 
 SCRIPT_PATH = pathlib.Path(__file__).resolve().parent
 
+BENCH_BASELINE = SCRIPT_PATH / 'tests' / 'bench_baseline.json'
+BENCH_REFERENCE_IMPL = 'libc snprintf'
+
 NINJA_URL = 'https://github.com/ninja-build/ninja/releases/download/v1.10.2/{}'
 CMAKE_URL = 'https://cmake.org/files/v3.22/{}'
 
@@ -48,6 +53,24 @@ def parse_args():
         action='store_true')
     parser.add_argument('--ubsan', action='store_true', help='Clang UB sanitizer')
     parser.add_argument('--asan', action='store_true', help='Clang addr sanitizer')
+    parser.add_argument(
+        '--bench',
+        help='Run the benchmarks and compare against tests/bench_baseline.json',
+        action='store_true')
+    parser.add_argument(
+        '--bench-runs',
+        type=int,
+        default=5,
+        help='Number of benchmark process runs to aggregate')
+    parser.add_argument(
+        '--bench-threshold',
+        type=float,
+        default=0.25,
+        help='Allowed fractional slowdown vs the baseline before failing')
+    parser.add_argument(
+        '--bench-update',
+        help='Rewrite tests/bench_baseline.json from this run',
+        action='store_true')
     parser.add_argument('-v', '--verbose', action='store_true', help='verbose')
     return parser.parse_args()
 
@@ -165,6 +188,83 @@ def build_cmake(cmake_exe, args):
         return cpe.returncode == 0
 
 
+def run_bench_once(bench_exe):
+    """Run the benchmark binary once, return {(workload, impl): ratio vs libc}."""
+    sys.stdout.flush()
+    out = subprocess.run([bench_exe, '--json'], check=True, capture_output=True, text=True)
+    rows = json.loads(out.stdout)
+    ref = {r['workload']: r['p50'] for r in rows if r['impl'] == BENCH_REFERENCE_IMPL}
+    return {(r['workload'], r['impl']): r['p50'] / ref[r['workload']]
+            for r in rows if r['impl'] != BENCH_REFERENCE_IMPL and r['workload'] in ref}
+
+
+def summarize_bench(runs):
+    """Reduce per-run ratios to median and [min, max] across runs.
+
+    With n runs, [min, max] covers the true median with probability
+    1 - 2^(1-n) (about 94% for the default 5 runs)."""
+    return [{'workload': key[0],
+             'impl': key[1],
+             'ratio': statistics.median(r[key] for r in runs),
+             'ratio_lo': min(r[key] for r in runs),
+             'ratio_hi': max(r[key] for r in runs)} for key in runs[0]]
+
+
+def compare_bench(results, baseline, threshold):
+    """Print each result against the baseline, return True if none regressed.
+
+    A workload only regresses if the low end of its interval is still slower
+    than the baseline by more than 'threshold', so noisy runs don't fail."""
+    ok = True
+    print(f'{"workload":<12} {"impl":<20} {"baseline":>9} {"ratio":>7} {"interval":>15}')
+    for res in results:
+        key = f'{res["workload"]}/{res["impl"]}'
+        base = baseline.get(key)
+        status, base_str = 'new', '-'
+        if base is not None:
+            regressed = res['ratio_lo'] > base * (1.0 + threshold)
+            ok = ok and not regressed
+            status = 'REGRESSED' if regressed else 'ok'
+            base_str = f'{base:.3f}'
+        print(f'{res["workload"]:<12} {res["impl"]:<20} '
+              f'{base_str:>9} {res["ratio"]:>7.3f} '
+              f'[{res["ratio_lo"]:.3f}, {res["ratio_hi"]:.3f}] {status}')
+    return ok
+
+
+def run_bench(args):
+    """Run npf_bench repeatedly, write JSON results, and gate on the baseline.
+
+    Timings are stored as ratios against the system snprintf measured in the
+    same process, so the committed baseline is portable across CI machines."""
+    build_path = SCRIPT_PATH / 'build' / 'ninja' / args.cfg
+    bench_exe = build_path / f'npf_bench{".exe" if sys.platform == "win32" else ""}'
+    if args.cfg != 'Release':
+        print(f'Warning: benchmarking a {args.cfg} build; the baseline is Release.')
+
+    runs = []
+    for i in range(args.bench_runs):
+        if args.verbose:
+            print(f'Benchmark run {i + 1}/{args.bench_runs}')
+        runs.append(run_bench_once(bench_exe))
+    results = summarize_bench(runs)
+
+    with open(build_path / 'bench.json', 'w', encoding='utf-8') as file:
+        json.dump({'runs': args.bench_runs, 'results': results}, file, indent=2)
+
+    if args.bench_update:
+        with open(BENCH_BASELINE, 'w', encoding='utf-8') as file:
+            json.dump({f'{r["workload"]}/{r["impl"]}': round(r['ratio'], 3) for r in results},
+                      file, indent=2)
+            file.write('\n')
+        print(f'Wrote {BENCH_BASELINE}')
+        return True
+
+    with open(BENCH_BASELINE, 'r', encoding='utf-8') as file:
+        baseline = json.load(file)
+    return compare_bench(results, baseline, args.bench_threshold)
+
+
 def main():
     """Parse args, find or get tools, configure CMake, build and run tests."""
     args = parse_args()
@@ -178,6 +278,8 @@ def main():
         print(f'Found ninja at {ninja}')
 
     built_ok = configure_cmake(cmake, ninja, args) and build_cmake(cmake, args)
+    if built_ok and args.bench:
+        built_ok = run_bench(args)
     return int(not built_ok)  # 0 is success
 
 
@@ -0,0 +1,86 @@
+// Format a large batch of records in parallel. Each npf_snprintf call only
+// touches its own stack and output slot, so workers need no synchronization.
+
+#define NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS 0
+#define NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS 0
+
+#define NANOPRINTF_IMPLEMENTATION
+#include "../../nanoprintf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+struct record {
+    unsigned long long timestamp;
+    unsigned id;
+    int level;
+    double value;
+    char const *msg;
+};
+
+enum { SLOT_SIZE = 128 };
+
+// Split [0, n) into contiguous chunks, one per worker, and format each record
+// into its own fixed-size output slot. Returns the formatted lengths in 'lens'.
+static void format_batch(record const *records,
+                         size_t n,
+                         char *out,
+                         int *lens,
+                         unsigned nthreads) {
+    auto work = [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            record const &r = records[i];
+            lens[i] = npf_snprintf(&out[i * SLOT_SIZE], SLOT_SIZE,
+                                   "%llu [%08x] L%d %-12s %.3f",
+                                   r.timestamp, r.id, r.level, r.msg, r.value);
+        }
+    };
+
+    if (nthreads < 2) { work(0, n); return; }
+
+    std::vector<std::thread> workers;
+    size_t const chunk = (n + nthreads - 1) / nthreads;
+    for (size_t begin = 0; begin < n; begin += chunk) {
+        workers.emplace_back(work, begin, (begin + chunk < n) ? begin + chunk : n);
+    }
+    for (auto &w : workers) { w.join(); }
+}
+
+int main(int argc, char const *argv[]) {
+    size_t const n = (argc > 1) ? (size_t)strtoul(argv[1], nullptr, 10) : 200000;
+    char const *msgs[] = { "connect", "disconnect", "timeout", "retry", "ok" };
+
+    std::vector<record> records(n);
+    for (size_t i = 0; i < n; ++i) {
+        records[i] = record{ 1700000000000ull + i, (unsigned)(i * 2654435761u),
+                             (int)(i % 5), (double)i / 7.0, msgs[i % 5] };
+    }
+
+    std::vector<char> out(n * SLOT_SIZE);
+    std::vector<int> lens(n);
+
+    unsigned const max_threads = std::thread::hardware_concurrency() ?
+        std::thread::hardware_concurrency() : 1;
+
+    double base_ms = 0;
+    // Double the thread count each step, and always end on every core.
+    for (unsigned t = 1;; t = std::min(t * 2, max_threads)) {
+        auto const start = std::chrono::steady_clock::now();
+        format_batch(records.data(), n, out.data(), lens.data(), t);
+        std::chrono::duration<double, std::milli> const ms =
+            std::chrono::steady_clock::now() - start;
+        if (t == 1) { base_ms = ms.count(); }
+        printf("%2u thread(s): %8.2f ms  (%.2fx)\n", t, ms.count(), base_ms / ms.count());
+        if (t == max_threads) { break; }
+    }
+
+    if (n) { printf("%s\n", &out[(n - 1) * SLOT_SIZE]); }
+}
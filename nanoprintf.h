@@ -16,7 +16,32 @@
   #define NPF_VISIBILITY extern
 #endif
 
-#if defined(__clang__) || defined(__GNUC__) || defined(__GNUG__)
+// The printf format attribute only knows the standard conversions, so it's left
+// out when nanoprintf's own conversions, or C23 ones that older compilers don't
+// know yet, are enabled; every use would be flagged.
+#if (defined(NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS == 1)) || \
+    (defined(NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1)) || \
+    (defined(NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1)) || \
+    (defined(NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1)) || \
+    (defined(NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1)) || \
+    (defined(NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1)) || \
+    (defined(NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1)) || \
+    (defined(NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS) && \
+     (NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1))
+  #define NPF_NONSTANDARD_CONVERSIONS 1
+#else
+  #define NPF_NONSTANDARD_CONVERSIONS 0
+#endif
+
+#if (defined(__clang__) || defined(__GNUC__) || defined(__GNUG__)) && \
+    !NPF_NONSTANDARD_CONVERSIONS
   #define NPF_PRINTF_ATTR(FORMAT_INDEX, VARGS_INDEX) \
     __attribute__((format(printf, FORMAT_INDEX, VARGS_INDEX)))
 #else
@@ -47,6 +72,164 @@ NPF_VISIBILITY int npf_pprintf(
 NPF_VISIBILITY int npf_vpprintf(
   npf_putc pc, void *pc_ctx, char const *format, va_list vlist) NPF_PRINTF_ATTR(3, 0);
 
+// Define NANOPRINTF_PPRINTF_EX to enable the npf_pprintf_ex functions. Their
+// callback returns 0 to accept a byte, or non-zero to reject it and stop
+// formatting. They return the number of bytes the callback accepted.
+#ifdef NANOPRINTF_PPRINTF_EX
+typedef int (*npf_putc_ex)(int c, void *ctx);
+NPF_VISIBILITY int npf_pprintf_ex(
+  npf_putc_ex pc, void *pc_ctx, char const *format, ...) NPF_PRINTF_ATTR(3, 4);
+
+NPF_VISIBILITY int npf_vpprintf_ex(
+  npf_putc_ex pc, void *pc_ctx, char const *format, va_list vlist) NPF_PRINTF_ATTR(3, 0);
+#endif
+
+// Define NANOPRINTF_PPRINTF_STATS to enable the npf_pprintf_stats functions. They
+// behave like npf_pprintf and also describe the call in *stats, which is useful
+// for sizing NANOPRINTF_CONVERSION_BUFFER_SIZE and output buffers.
+#ifdef NANOPRINTF_PPRINTF_STATS
+typedef struct npf_stats {
+  int bytes;           // total bytes emitted, same as the return value
+  int literal_bytes;   // bytes copied from the format string
+  int converted_bytes; // bytes emitted by conversions, including padding
+  int directives;      // conversion specifications, including "%%"
+  int max_cbuf_len;    // most conversion buffer bytes used by a single conversion
+} npf_stats_t;
+
+NPF_VISIBILITY int npf_pprintf_stats(npf_putc pc, void *pc_ctx, npf_stats_t *stats,
+  char const *format, ...) NPF_PRINTF_ATTR(4, 5);
+
+NPF_VISIBILITY int npf_vpprintf_stats(npf_putc pc, void *pc_ctx, npf_stats_t *stats,
+  char const *format, va_list vlist) NPF_PRINTF_ATTR(4, 0);
+#endif
+
+// Define NANOPRINTF_IOVEC to enable the npf_ioprintf functions. Instead of
+// copying output, they describe it as up to *iovcnt segments. Literal text points
+// into 'format', strings point at the string arguments, and everything else
+// (numbers, padding, etc) is written into 'scratch'. The segment layout matches
+// POSIX struct iovec. On return, *iovcnt holds the number of segments used.
+// They return the total length, or -1 if the segments or scratch ran out.
+#if defined(NANOPRINTF_IOVEC) || defined(NANOPRINTF_DPRINTF)
+typedef struct npf_iovec {
+  void const *iov_base;
+  size_t iov_len;
+} npf_iovec_t;
+#endif
+
+#ifdef NANOPRINTF_IOVEC
+NPF_VISIBILITY int npf_ioprintf(npf_iovec_t *iov, int *iovcnt, char *scratch,
+  size_t scratch_sz, char const *format, ...) NPF_PRINTF_ATTR(5, 6);
+
+NPF_VISIBILITY int npf_vioprintf(npf_iovec_t *iov, int *iovcnt, char *scratch,
+  size_t scratch_sz, char const *format, va_list vlist) NPF_PRINTF_ATTR(5, 0);
+#endif
+
+// Define NANOPRINTF_DPRINTF to enable the npf_dprintf functions, which write to a
+// POSIX file descriptor. Output is described as segments like npf_ioprintf, on the
+// stack, and a line costs a single writev(2) unless it needs more than
+// NANOPRINTF_DPRINTF_IOV_COUNT segments or NANOPRINTF_DPRINTF_BUFFER_SIZE bytes
+// of converted output; then it's written in several. They return the number of
+// bytes written, or -1 if a write fails, in which case formatting stops.
+#ifdef NANOPRINTF_DPRINTF
+NPF_VISIBILITY int npf_dprintf(int fd, char const *format, ...) NPF_PRINTF_ATTR(2, 3);
+
+NPF_VISIBILITY int npf_vdprintf(
+  int fd, char const *format, va_list vlist) NPF_PRINTF_ATTR(2, 0);
+#endif
+
+// Define NANOPRINTF_SNPRINTF_TRUNC to enable the npf_snprintf_trunc functions.
+// They stop formatting at the first byte that doesn't fit into the buffer (minus
+// the null terminator), and return the number of bytes actually written. If
+// 'truncated' is non-NULL, it's set to 1 when output was cut short, 0 otherwise.
+#ifdef NANOPRINTF_SNPRINTF_TRUNC
+NPF_VISIBILITY int npf_snprintf_trunc(char *buffer, size_t bufsz, int *truncated,
+  char const *format, ...) NPF_PRINTF_ATTR(4, 5);
+
+NPF_VISIBILITY int npf_vsnprintf_trunc(char *buffer, size_t bufsz, int *truncated,
+  char const *format, va_list vlist) NPF_PRINTF_ATTR(4, 0);
+#endif
+
+// Define NANOPRINTF_ASPRINTF_REALLOC and NANOPRINTF_ASPRINTF_FREE to enable the
+// npf_asprintf functions. They format into a heap string, which the caller frees,
+// and return -1 (with *strp set to NULL) if an allocation fails.
+#ifdef NANOPRINTF_ASPRINTF_REALLOC
+NPF_VISIBILITY int npf_asprintf(
+  char **strp, char const *format, ...) NPF_PRINTF_ATTR(2, 3);
+
+NPF_VISIBILITY int npf_vasprintf(
+  char **strp, char const *format, va_list vlist) NPF_PRINTF_ATTR(2, 0);
+#endif
+
+// Set NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS to 1 to enable npf_ftoa32, which
+// formats a float like "%.*f" using only 32-bit arithmetic (given the default
+// NANOPRINTF_CONVERSION_FLOAT_TYPE). A negative precision means the default of 6.
+// It returns the same value as npf_snprintf would.
+#if defined(NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS) && \
+    (NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS == 1)
+NPF_VISIBILITY int npf_ftoa32(char *buffer, size_t bufsz, float f, int precision);
+#endif
+
+// Set NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS to 1 to enable %T, which prints
+// a UTC ISO-8601 timestamp like "2024-05-17T08:30:15.250Z" from a pointer to an
+// npf_timestamp_t. The precision is the number of fraction digits (default 0,
+// at most 9), which are truncated. Keep one npf_timestamp_t per logger or thread:
+// it caches the rendered date, hour and minute, so while 'sec' stays in the same
+// minute only the seconds and fraction are rendered again. Zero it before use.
+#if defined(NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS) && \
+    (NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1)
+typedef struct npf_timestamp {
+  long long sec; // seconds since 1970-01-01T00:00:00Z
+  long nsec;     // sub-second part, 0 to 999999999
+  // The last rendered text, "YYYY-MM-DDTHH:MM:" plus the seconds.
+  long long minute;
+  int prefix_len; // 0 until the first render
+  char text[40];
+} npf_timestamp_t;
+#endif
+
+// Define NANOPRINTF_PROFILE to count, for each kind of conversion, how many ran,
+// how many bytes they emitted, and how many of those bytes were padding. When a
+// cycle counter is available the ticks spent converting are summed as well.
+// The counters are global to the implementation and aren't synchronized.
+#ifdef NANOPRINTF_PROFILE
+typedef enum {
+  NPF_PROFILE_CONV_PERCENT,
+  NPF_PROFILE_CONV_CHAR,
+  NPF_PROFILE_CONV_STRING,
+  NPF_PROFILE_CONV_SIGNED_INT,
+  NPF_PROFILE_CONV_BINARY,
+  NPF_PROFILE_CONV_OCTAL,
+  NPF_PROFILE_CONV_HEX_INT,
+  NPF_PROFILE_CONV_UNSIGNED_INT,
+  NPF_PROFILE_CONV_POINTER,
+  NPF_PROFILE_CONV_WRITEBACK,
+  NPF_PROFILE_CONV_FLOAT_DEC,
+  NPF_PROFILE_CONV_FLOAT_SCI,
+  NPF_PROFILE_CONV_FLOAT_SHORTEST,
+  NPF_PROFILE_CONV_FLOAT_HEX,
+  NPF_PROFILE_CONV_FIXED_POINT,
+  NPF_PROFILE_CONV_SCALED_DEC,
+  NPF_PROFILE_CONV_UNIT_PREFIX,
+  NPF_PROFILE_CONV_DURATION,
+  NPF_PROFILE_CONV_TIMESTAMP,
+  NPF_PROFILE_CONV_COUNT
+} npf_profile_conv_t;
+
+typedef struct npf_profile_counters {
+  unsigned long long count;
+  unsigned long long bytes;     // including padding
+  unsigned long long pad_bytes; // field width and precision padding
+  unsigned long long cycles;    // 0 without a cycle counter
+} npf_profile_counters_t;
+
+typedef struct npf_profile {
+  npf_profile_counters_t conv[NPF_PROFILE_CONV_COUNT]; // indexed by npf_profile_conv_t
+} npf_profile_t;
+
+NPF_VISIBILITY void npf_profile_snapshot(npf_profile_t *out);
+NPF_VISIBILITY void npf_profile_reset(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -66,11 +249,87 @@ NPF_VISIBILITY int npf_vpprintf(
 #include <stdint.h>
 
 // The conversion buffer must fit at least UINT64_MAX in octal format with the leading '0'.
+// With 128-bit support, it must fit UINT128_MAX in octal format with the leading '0'.
+#if defined(NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS) && \
+    (NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1)
+  #define NPF_MIN_CONVERSION_BUFFER_SIZE 44
+#else
+  #define NPF_MIN_CONVERSION_BUFFER_SIZE 23
+#endif
 #ifndef NANOPRINTF_CONVERSION_BUFFER_SIZE
-  #define NANOPRINTF_CONVERSION_BUFFER_SIZE    23
+  #define NANOPRINTF_CONVERSION_BUFFER_SIZE    NPF_MIN_CONVERSION_BUFFER_SIZE
+#endif
+#if NANOPRINTF_CONVERSION_BUFFER_SIZE < NPF_MIN_CONVERSION_BUFFER_SIZE
+  #error The conversion buffer must be at least 23 bytes (44 with 128-bit support).
+#endif
+
+// Heap strings are formatted into a stack buffer first, only allocating once
+// they outgrow it.
+#ifdef NANOPRINTF_ASPRINTF_REALLOC
+  #ifndef NANOPRINTF_ASPRINTF_FREE
+    #error NANOPRINTF_ASPRINTF_FREE must be defined alongside NANOPRINTF_ASPRINTF_REALLOC.
+  #endif
+  #ifndef NANOPRINTF_ASPRINTF_STACK_SIZE
+    #define NANOPRINTF_ASPRINTF_STACK_SIZE 64
+  #endif
+  #if NANOPRINTF_ASPRINTF_STACK_SIZE < 1
+    #error The size of the asprintf stack buffer must be at least 1 byte.
+  #endif
+#endif
+
+// File descriptor output collects segments on the stack and writes with writev(2)
+// by default. npf_iovec_t has the layout of struct iovec.
+#ifdef NANOPRINTF_DPRINTF
+  #ifndef NANOPRINTF_DPRINTF_BUFFER_SIZE
+    #define NANOPRINTF_DPRINTF_BUFFER_SIZE 128
+  #endif
+  #if NANOPRINTF_DPRINTF_BUFFER_SIZE < 1
+    #error The size of the dprintf buffer must be at least 1 byte.
+  #endif
+  #ifndef NANOPRINTF_DPRINTF_IOV_COUNT
+    #define NANOPRINTF_DPRINTF_IOV_COUNT 16
+  #endif
+  #if NANOPRINTF_DPRINTF_IOV_COUNT < 1
+    #error dprintf needs at least 1 segment.
+  #endif
+  #ifndef NANOPRINTF_DPRINTF_WRITEV
+    #include <sys/uio.h>
+    #define NANOPRINTF_DPRINTF_WRITEV(FD, IOV, CNT) \
+      writev((FD), (struct iovec const *)(void const *)(IOV), (CNT))
+  #endif
+  #include <errno.h>
+#endif
+
+// Profiling times conversions with NANOPRINTF_PROFILE_CLOCK(), which defaults to
+// the x86 TSC or the AArch64 virtual counter. Define it to supply your own clock.
+#ifdef NANOPRINTF_PROFILE
+  #ifndef NANOPRINTF_PROFILE_CLOCK
+    #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+      #include <intrin.h>
+      #define NANOPRINTF_PROFILE_CLOCK() __rdtsc()
+    #elif (defined(__GNUC__) || defined(__clang__)) && \
+          (defined(__x86_64__) || defined(__i386__))
+      #define NANOPRINTF_PROFILE_CLOCK() __builtin_ia32_rdtsc()
+    #elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+      #define NANOPRINTF_PROFILE_CLOCK() npf_profile_cntvct()
+      #define NPF_PROFILE_CNTVCT
+    #endif
+  #endif
+#endif
+
+// Some sinks can ask the formatter to stop early.
+#if defined(NANOPRINTF_SNPRINTF_TRUNC) || defined(NANOPRINTF_PPRINTF_EX) || \
+    defined(NANOPRINTF_IOVEC) || defined(NANOPRINTF_DPRINTF)
+  #define NPF_HAVE_SINK_STOP 1
+#else
+  #define NPF_HAVE_SINK_STOP 0
 #endif
-#if NANOPRINTF_CONVERSION_BUFFER_SIZE < 23
-  #error The size of the conversion buffer must be at least 23 bytes.
+
+// Sinks that take output as segments instead of bytes.
+#if defined(NANOPRINTF_IOVEC) || defined(NANOPRINTF_DPRINTF)
+  #define NPF_HAVE_IOV 1
+#else
+  #define NPF_HAVE_IOV 0
 #endif
 
 // Pick reasonable defaults if nothing's been configured.
@@ -114,6 +373,97 @@ NPF_VISIBILITY int npf_vpprintf(
   #error Precision format specifiers must be enabled if float support is enabled.
 #endif
 
+// C23 fixed-width and 128-bit integers are opt-in, and not part of the
+// all-or-nothing set above.
+#ifndef NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS 0
+#endif
+#ifndef NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS 0
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  #if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 0
+    #error Large format specifiers must be enabled if 128-bit support is enabled.
+  #endif
+  #ifndef __SIZEOF_INT128__
+    #error 128-bit format specifiers require compiler support for __int128.
+  #endif
+#endif
+
+// Native long double conversion is opt-in; by default %L values are cast to double.
+#ifndef NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS 0
+#endif
+#if (NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS == 1) && \
+    (NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 0)
+  #error Float format specifiers must be enabled if long double support is enabled.
+#endif
+
+// Single-precision conversion (%hf of binary32 bits, npf_ftoa32) is opt-in too.
+#ifndef NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS 0
+#endif
+#if (NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS == 1) && \
+    (NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 0)
+  #error Float format specifiers must be enabled if float32 support is enabled.
+#endif
+
+// Exact (glibc-identical) float conversion is opt-in; it's bigger, slower and
+// uses more stack than the default approximate algorithm.
+#ifndef NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS 0
+#endif
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+  #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 0
+    #error Float format specifiers must be enabled if exact float support is enabled.
+  #endif
+  #if NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS == 1
+    #error Exact float conversion supports double only, not native long double.
+  #endif
+#endif
+
+// Binary fixed-point conversion (%k, %K) reuses the float digit generator.
+#ifndef NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS 0
+#endif
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+  #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 0
+    #error Float format specifiers must be enabled if fixed-point support is enabled.
+  #endif
+  #if (NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1) && \
+      (NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1)
+    #error Exact fixed-point conversion supports values up to 64 bits, not 128.
+  #endif
+#endif
+
+// Scaled-decimal integer conversion (%D, %U) is opt-in.
+#ifndef NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS 0
+#endif
+
+// SI and IEC unit prefix conversion (%M, %I) is opt-in.
+#ifndef NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS 0
+#endif
+
+// Nanosecond duration conversion (%N) is opt-in.
+#ifndef NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS 0
+#endif
+
+// ISO-8601 timestamp conversion (%T) is opt-in.
+#ifndef NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS
+  #define NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS 0
+#endif
+
+// Can npf_uint_t hold 64-bit values? If so, values that fit in 32 bits get a
+// 32-bit conversion kernel.
+#if (NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1) || (ULONG_MAX > 0xFFFFFFFFu)
+  #define NPF_WIDE_UINT 1
+#else
+  #define NPF_WIDE_UINT 0
+#endif
+
 // intmax_t / uintmax_t require stdint from c99 / c++11
 #if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
   #ifndef _MSC_VER
@@ -217,6 +567,17 @@ enum {
   NPF_FMT_SPEC_LEN_MOD_LARGE_SIZET,     // 'z'
   NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT,  // 't'
 #endif
+#if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_LEN_MOD_W8,              // 'w8', or 'wfN' if int_fastN_t is 8 bits
+  NPF_FMT_SPEC_LEN_MOD_W16,             // 'w16'
+  NPF_FMT_SPEC_LEN_MOD_W32,             // 'w32'
+#if NPF_WIDE_UINT == 1
+  NPF_FMT_SPEC_LEN_MOD_W64,             // 'w64'
+#endif
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_LEN_MOD_LARGE_INT128,    // 'w128'
+#endif
 };
 
 enum {
@@ -241,6 +602,24 @@ enum {
   NPF_FMT_SPEC_CONV_FLOAT_SHORTEST, // 'g', 'G'
   NPF_FMT_SPEC_CONV_FLOAT_HEX,      // 'a', 'A'
 #endif
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_FIXED_POINT,    // 'k'
+  NPF_FMT_SPEC_CONV_UFIXED_POINT,   // 'K'
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_SCALED_DEC,     // 'D'
+  NPF_FMT_SPEC_CONV_USCALED_DEC,    // 'U'
+#endif
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_SI_PREFIX,      // 'M'
+  NPF_FMT_SPEC_CONV_IEC_PREFIX,     // 'I'
+#endif
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_DURATION,       // 'N'
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+  NPF_FMT_SPEC_CONV_TIMESTAMP,      // 'T'
+#endif
 };
 
 typedef struct npf_format_spec {
@@ -261,7 +640,10 @@ typedef struct npf_format_spec {
   uint8_t conv_spec;
 } npf_format_spec_t;
 
-#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 0
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  __extension__ typedef __int128 npf_int_t;
+  __extension__ typedef unsigned __int128 npf_uint_t;
+#elif NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 0
   typedef long npf_int_t;
   typedef unsigned long npf_uint_t;
 #else
@@ -275,6 +657,55 @@ typedef struct npf_bufputc_ctx {
   size_t cur;
 } npf_bufputc_ctx_t;
 
+#if NPF_HAVE_IOV
+typedef struct npf_iov_putc_ctx {
+  npf_iovec_t *iov;
+  int iov_len;
+  int iov_cur;
+  char *scratch;
+  size_t scratch_len;
+  size_t scratch_cur;
+  int full;
+} npf_iov_putc_ctx_t;
+#endif
+
+#ifdef NANOPRINTF_DPRINTF
+typedef struct npf_fdputc_ctx {
+  npf_iov_putc_ctx_t ipc; // pending output, written when it runs out of room
+  int fd;
+  int err;
+  int n;
+  npf_iovec_t iov[NANOPRINTF_DPRINTF_IOV_COUNT];
+  char scratch[NANOPRINTF_DPRINTF_BUFFER_SIZE];
+} npf_fdputc_ctx_t;
+#endif
+
+#ifdef NANOPRINTF_PPRINTF_EX
+typedef struct npf_ex_putc_ctx {
+  npf_putc_ex pc;
+  void *ctx;
+  int n;
+  int stop;
+} npf_ex_putc_ctx_t;
+#endif
+
+#ifdef NANOPRINTF_SNPRINTF_TRUNC
+typedef struct npf_trunc_putc_ctx {
+  npf_bufputc_ctx_t buf;
+  int full;
+} npf_trunc_putc_ctx_t;
+#endif
+
+#ifdef NANOPRINTF_ASPRINTF_REALLOC
+typedef struct npf_asputc_ctx {
+  char *dst;  // the stack buffer until it overflows, then 'heap'
+  char *heap;
+  size_t len;
+  size_t cur;
+  int err;
+} npf_asputc_ctx_t;
+#endif
+
 #if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
   typedef char npf_size_is_ptrdiff[(sizeof(size_t) == sizeof(ptrdiff_t)) ? 1 : -1];
   typedef ptrdiff_t npf_ssize_t;
@@ -372,6 +803,44 @@ static int npf_parse_format_spec(char const *format, npf_format_spec_t *out_spec
     case 'j': out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_LARGE_INTMAX; break;
     case 'z': out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_LARGE_SIZET; break;
     case 't': out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_LARGE_PTRDIFFT; break;
+#endif
+#if (NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1)
+    case 'w': {
+      int bits = 0;
+#if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
+      int const fast = (*cur == 'f');
+      cur += fast;
+#endif
+      for (int i = 0; (i < 3) && (*cur >= '0') && (*cur <= '9'); ++i) {
+        bits = (bits * 10) + (*cur++ - '0');
+      }
+#if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
+      if (fast) { // The fast types share the exact-width type of the same size.
+        switch (bits) {
+          case 8: bits = (int)(sizeof(int_fast8_t) * CHAR_BIT); break;
+          case 16: bits = (int)(sizeof(int_fast16_t) * CHAR_BIT); break;
+          case 32: bits = (int)(sizeof(int_fast32_t) * CHAR_BIT); break;
+          case 64: bits = (int)(sizeof(int_fast64_t) * CHAR_BIT); break;
+          default: return 0;
+        }
+      }
+#endif
+      switch (bits) {
+#if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
+        case 8: out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_W8; break;
+        case 16: out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_W16; break;
+        case 32: out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_W32; break;
+#if NPF_WIDE_UINT == 1
+        case 64: out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_W64; break;
+#endif
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+        case 128: out_spec->length_modifier = NPF_FMT_SPEC_LEN_MOD_LARGE_INT128; break;
+#endif
+        default: return 0;
+      }
+    } break;
 #endif
     default: --cur; break;
   }
@@ -438,6 +907,33 @@ static int npf_parse_format_spec(char const *format, npf_format_spec_t *out_spec
       break;
 #endif
 
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+    case 'k': out_spec->conv_spec = NPF_FMT_SPEC_CONV_FIXED_POINT; break;
+    case 'K': out_spec->conv_spec = NPF_FMT_SPEC_CONV_UFIXED_POINT; break;
+#endif
+
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+    case 'D': out_spec->conv_spec = NPF_FMT_SPEC_CONV_SCALED_DEC; break;
+    case 'U': out_spec->conv_spec = NPF_FMT_SPEC_CONV_USCALED_DEC; break;
+#endif
+
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+    case 'M': out_spec->conv_spec = NPF_FMT_SPEC_CONV_SI_PREFIX; break;
+    case 'I': out_spec->conv_spec = NPF_FMT_SPEC_CONV_IEC_PREFIX; break;
+#endif
+
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+    case 'N': out_spec->conv_spec = NPF_FMT_SPEC_CONV_DURATION; break;
+#endif
+
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+    case 'T': out_spec->conv_spec = NPF_FMT_SPEC_CONV_TIMESTAMP;
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+      out_spec->leading_zero_pad = 0;
+#endif
+      break;
+#endif
+
 #if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
     case 'n':
       // todo: reject string if flags or width or precision exist
@@ -469,8 +965,9 @@ static int npf_parse_format_spec(char const *format, npf_format_spec_t *out_spec
   return (int)(cur - format);
 }
 
-static NPF_NOINLINE int npf_utoa_rev(
-    npf_uint_t val, char *buf, uint_fast8_t base, char case_adj) {
+#if NPF_WIDE_UINT == 1
+// npf_uint_t is 64 bits or more, but most values fit in 32; skip the wide math.
+static int npf_utoa32_rev(uint32_t val, char *buf, uint_fast8_t base, char case_adj) {
   uint_fast8_t n = 0;
   do {
     int_fast8_t const d = (int_fast8_t)(val % base);
@@ -480,46 +977,164 @@ static NPF_NOINLINE int npf_utoa_rev(
   } while (val);
   return (int)n;
 }
+#endif
+
+static NPF_NOINLINE int npf_utoa_rev(
+    npf_uint_t val, char *buf, uint_fast8_t base, char case_adj) {
+  uint_fast8_t n = 0;
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  // Peel off 19 decimal digits per 128-bit division (or shift out power-of-2
+  // digits) until the rest fits in 64 bits, then finish with 64-bit math.
+  while (val >> 64) {
+    if (base == 10) {
+      npf_uint_t const q = val / UINT64_C(10000000000000000000);
+      uint64_t r = (uint64_t)(val - (q * UINT64_C(10000000000000000000)));
+      for (int i = 0; i < 19; ++i, r /= 10) { *buf++ = (char)('0' + (char)(r % 10)); }
+      n = (uint_fast8_t)(n + 19);
+      val = q;
+    } else {
+      int_fast8_t const d = (int_fast8_t)(val & (base - 1u));
+      *buf++ = (char)(((d < 10) ? '0' : ('A' - 10 + case_adj)) + d);
+      ++n;
+      val >>= (base == 16) ? 4 : 3;
+    }
+  }
+  uint64_t u = (uint64_t)val;
+#else
+  npf_uint_t u = val;
+#endif
+#if NPF_WIDE_UINT == 1
+  // Wide division only for the digits above 32 bits; the 32-bit loop does the rest.
+  while (u > 0xFFFFFFFFu) {
+    int_fast8_t const d = (int_fast8_t)(u % base);
+    *buf++ = (char)(((d < 10) ? '0' : ('A' - 10 + case_adj)) + d);
+    ++n;
+    u /= base;
+  }
+  return (int)n + npf_utoa32_rev((uint32_t)u, buf, base, case_adj);
+#else
+  do {
+    int_fast8_t const d = (int_fast8_t)(u % base);
+    *buf++ = (char)(((d < 10) ? '0' : ('A' - 10 + case_adj)) + d);
+    ++n;
+    u /= base;
+  } while (u);
+  return (int)n;
+#endif
+}
+
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+// Converts val / 10^scale with the precision's fraction digits (default: scale),
+// rounding half away from zero. A negative scale appends '0's to val.
+static int npf_dtoa_rev(char *buf, npf_format_spec_t const *spec, npf_uint_t val,
+                        int scale) {
+  int const lim = NANOPRINTF_CONVERSION_BUFFER_SIZE;
+  scale = (scale < -lim) ? -lim : ((scale > lim) ? lim : scale);
+  int prec = (scale < 0) ? 0 : scale;
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+  if (spec->prec_opt != NPF_FMT_SPEC_OPT_NONE) { prec = spec->prec; }
+#endif
+  int const dot = (prec || spec->alt_form);
+
+  uint_fast8_t up = 0; // the most significant dropped digit is the last one
+  for (; scale > prec; --scale) { up = ((val % 10) >= 5); val /= 10; }
+  val += up;
+
+  int n = npf_utoa_rev(val, buf, 10, 0);
+  int const zeros = prec - scale; // after the digits of val
+  if ((npf_max(n + zeros, prec + 1) + dot) > lim) {
+    buf[0] = (char)('R' + spec->case_adjust);
+    buf[1] = (char)('R' + spec->case_adjust);
+    buf[2] = (char)('E' + spec->case_adjust);
+    return 3;
+  }
+  for (int i = n; i--; ) { buf[i + zeros] = buf[i]; }
+  for (int i = 0; i < zeros; ++i) { buf[i] = '0'; }
+  for (n += zeros; n <= prec; ) { buf[n++] = '0'; } // "0." before short fractions
+  if (dot) {
+    for (int i = n++; i > prec; --i) { buf[i] = buf[i - 1]; }
+    buf[prec] = '.';
+  }
+  return n;
+}
+#endif
 
 #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
 
 #include <float.h>
 
-#if (DBL_MANT_DIG <= 11) && (DBL_MAX_EXP <= 16)
+// With native long double support, doubles are widened (exactly) to long double
+// and every conversion runs on the long double layout.
+#if NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS == 1
+  typedef long double npf_ftoa_float_t;
+  #define NPF_FTOA_MANT_DIG LDBL_MANT_DIG
+  #define NPF_FTOA_MAX_EXP LDBL_MAX_EXP
+#else
+  typedef double npf_ftoa_float_t;
+  #define NPF_FTOA_MANT_DIG DBL_MANT_DIG
+  #define NPF_FTOA_MAX_EXP DBL_MAX_EXP
+#endif
+
+#if (NPF_FTOA_MANT_DIG <= 11) && (NPF_FTOA_MAX_EXP <= 16)
   typedef uint_fast16_t npf_double_bin_t;
   typedef int_fast8_t npf_ftoa_exp_t;
-#elif (DBL_MANT_DIG <= 24) && (DBL_MAX_EXP <= 128)
+#elif (NPF_FTOA_MANT_DIG <= 24) && (NPF_FTOA_MAX_EXP <= 128)
   typedef uint_fast32_t npf_double_bin_t;
   typedef int_fast8_t npf_ftoa_exp_t;
-#elif (DBL_MANT_DIG <= 53) && (DBL_MAX_EXP <= 1024)
+#elif (NPF_FTOA_MANT_DIG <= 53) && (NPF_FTOA_MAX_EXP <= 1024)
   typedef uint_fast64_t npf_double_bin_t;
   typedef int_fast16_t npf_ftoa_exp_t;
+#elif (NPF_FTOA_MANT_DIG == 64) && (NPF_FTOA_MAX_EXP == 16384) && \
+      (defined(__x86_64__) || defined(__i386__))
+  // x87 extended: 64-bit significand with an explicit integer bit, then the
+  // sign and 15-bit exponent in the next 16 bits.
+  #define NPF_FTOA_X87_EXTENDED
+  typedef uint64_t npf_double_bin_t;
+  typedef int_fast16_t npf_ftoa_exp_t;
+#elif (NPF_FTOA_MANT_DIG == 113) && (NPF_FTOA_MAX_EXP == 16384) && \
+      defined(__SIZEOF_INT128__)
+  // IEEE binary128, same layout as double with a 15-bit exponent.
+  __extension__ typedef unsigned __int128 npf_double_bin_t;
+  typedef int_fast16_t npf_ftoa_exp_t;
 #else
   #error Unsupported width of the double type.
 #endif
 
-// The floating point conversion code works with an unsigned integer type of any size.
+// The floating point conversion code works with an unsigned integer type of any size,
+// up to unsigned __int128.
 #ifndef NANOPRINTF_CONVERSION_FLOAT_TYPE
   #define NANOPRINTF_CONVERSION_FLOAT_TYPE unsigned int
 #endif
-typedef NANOPRINTF_CONVERSION_FLOAT_TYPE npf_ftoa_man_t;
-
-#if (NANOPRINTF_CONVERSION_BUFFER_SIZE <= UINT_FAST8_MAX) && (UINT_FAST8_MAX <= INT_MAX)
-  typedef uint_fast8_t npf_ftoa_dec_t;
-#else
-  typedef int npf_ftoa_dec_t;
+#if defined(__GNUC__) || defined(__clang__)
+  __extension__ // unsigned __int128 is a pedantic warning otherwise
 #endif
+typedef NANOPRINTF_CONVERSION_FLOAT_TYPE npf_ftoa_man_t;
 
 enum {
-  NPF_DOUBLE_EXP_MASK = DBL_MAX_EXP * 2 - 1,
-  NPF_DOUBLE_EXP_BIAS = DBL_MAX_EXP - 1,
-  NPF_DOUBLE_MAN_BITS = DBL_MANT_DIG - 1,
+  NPF_DOUBLE_EXP_MASK = NPF_FTOA_MAX_EXP * 2 - 1,
+  NPF_DOUBLE_EXP_BIAS = NPF_FTOA_MAX_EXP - 1,
+  NPF_DOUBLE_MAN_BITS = NPF_FTOA_MANT_DIG - 1,
   NPF_DOUBLE_BIN_BITS = sizeof(npf_double_bin_t) * CHAR_BIT,
   NPF_FTOA_MAN_BITS   = sizeof(npf_ftoa_man_t) * CHAR_BIT,
   NPF_FTOA_SHIFT_BITS =
-    ((NPF_FTOA_MAN_BITS < DBL_MANT_DIG) ? NPF_FTOA_MAN_BITS : DBL_MANT_DIG) - 1
+    ((NPF_FTOA_MAN_BITS < NPF_FTOA_MANT_DIG) ? NPF_FTOA_MAN_BITS : NPF_FTOA_MANT_DIG) - 1,
+#if NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS == 1
+  NPF_FLOAT32_EXP_MASK = 0xFF,
+  NPF_FLOAT32_EXP_BIAS = 127,
+  NPF_FLOAT32_MAN_BITS = 23,
+  NPF_FLOAT32_BIN_BITS = 32,
+  NPF_FTOA32_SHIFT_BITS =
+    ((NPF_FTOA_MAN_BITS < NPF_FLOAT32_MAN_BITS + 1) ?
+      NPF_FTOA_MAN_BITS : (NPF_FLOAT32_MAN_BITS + 1)) - 1,
+#endif
 };
 
+// The integer digits of a float (every digit of npf_ftoa_man_t, plus a rounding
+// carry) must fit the conversion buffer; 128-bit types need 40 bytes. The rest
+// streams through npf_ftoa_tail_t, so the digit loops don't check the bounds.
+typedef char npf_ftoa_int_fits[
+  ((NPF_FTOA_MAN_BITS * 3 / 10 + 2) <= NANOPRINTF_CONVERSION_BUFFER_SIZE) ? 1 : -1];
+
 /* Generally, floating-point conversion implementations use
    grisu2 (https://bit.ly/2JgMggX) and ryu (https://bit.ly/2RLXSg0) algorithms,
    which are mathematically exact and fast, but require large lookup tables.
@@ -529,167 +1144,640 @@ enum {
    extended further by adding dynamic scaling and configurable integer width by
    Oskars Rubenis (https://github.com/Okarss). */
 
-static int npf_ftoa_rev(char *buf, npf_format_spec_t const *spec, double f) {
-  char const *ret = NULL;
-  npf_double_bin_t bin; { // Union-cast is UB pre-C11, compiler optimizes byte-copy loop.
-    char const *src = (char const *)&f;
-    char *dst = (char *)&bin;
-    for (uint_fast8_t i = 0; i < sizeof(f); ++i) { dst[i] = src[i]; }
-  }
+// The largest precision npf_ftoa_digits_rev formats with a single multiply. Those
+// fraction digits and the dot go in the conversion buffer before the integer.
+#ifndef NPF_FTOA_FAST_PREC
+  #define NPF_FTOA_FAST_PREC 9
+#endif
+typedef char npf_ftoa_fast_fits[((NPF_FTOA_MAN_BITS > 32) ||
+  ((NPF_FTOA_MAN_BITS * 3 / 10 + 3 + NPF_FTOA_FAST_PREC) <=
+   NANOPRINTF_CONVERSION_BUFFER_SIZE)) ? 1 : -1];
+
+// A float split into integer and fraction mantissas, before base-10 scaling.
+// The layout-specific npf_ftoa*_rev functions fill it in for npf_ftoa_digits_rev,
+// so only they touch the (possibly wide) binary representation.
+typedef struct npf_ftoa_parts {
+  npf_ftoa_man_t man_i; // integer part, times 2^exp_i
+  npf_ftoa_man_t man_f; // left-aligned fraction part, times 2^exp_f
+  npf_ftoa_exp_t exp_i;
+  npf_ftoa_exp_t exp_f;
+  uint_fast8_t carry_i; // first bit shifted out of man_i
+  uint_fast8_t carry_f; // first bit shifted out of man_f
+  uint_fast8_t has_f;   // zero if the fraction bits are below the precision
+} npf_ftoa_parts_t;
+
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+/* Exact conversion expands m * 2^e digit by digit with small bignums on the
+   stack and rounds to nearest, ties to even, so the output matches glibc. The
+   integer part is kept in base-1e9 chunks. The fraction is w[3..] / 2^k in
+   32-bit limbs; each multiply by 5^9 (and k -= 9) lifts the next 9 digits above
+   bit k. A value has either a large integer part or a long fraction, never
+   both, so they share one buffer; any 64-bit integer part fits w[0..2]. */
+enum {
+  NPF_FTOA_EXACT_CHUNKS = (DBL_MAX_10_EXP + 9) / 9,
+  NPF_FTOA_EXACT_LIMBS = 3 + (DBL_MANT_DIG - DBL_MIN_EXP + 21 + 31) / 32,
+  NPF_FTOA_EXACT_WORDS = (NPF_FTOA_EXACT_CHUNKS > NPF_FTOA_EXACT_LIMBS) ?
+    NPF_FTOA_EXACT_CHUNKS : NPF_FTOA_EXACT_LIMBS,
+};
 
-  // Unsigned -> signed int casting is IB and can raise a signal but generally doesn't.
-  npf_ftoa_exp_t exp =
-    (npf_ftoa_exp_t)((npf_ftoa_exp_t)(bin >> NPF_DOUBLE_MAN_BITS) & NPF_DOUBLE_EXP_MASK);
+// The digits of a converted float, generated one character at a time by
+// npf_ftoa_tail_next. Rounding only changes the last non-9 digit and the 9s
+// after it, so those are held back until the digit after them is known.
+typedef struct npf_ftoa_tail {
+  uint32_t w[NPF_FTOA_EXACT_WORDS]; // integer chunks, then fraction limbs from w[3]
+  int n_i;       // integer chunks not loaded into dig yet
+  int n_f;       // fraction limbs in use
+  int k;         // fraction bits left
+  int n_dig;     // digits left in dig
+  int left;      // digits left to fetch
+  int pend;      // held back digit (never 9), or -1
+  int nines;     // held back 9s after pend
+  int look;      // the non-9 digit after them, or -1 if all digits are fetched
+  int last;      // the last digit fetched
+  int up;        // the digits round up, once look is -1
+  int int_left;  // integer digits left to print
+  int dot;       // non-zero if the decimal separator is pending
+  int frac_left; // fraction digits left to print
+  char dig[9];   // digits of the current chunk, the next one last
+} npf_ftoa_tail_t;
+
+static int npf_ftoa_tail_len(npf_ftoa_tail_t const *t) {
+  return t->int_left + t->dot + t->frac_left;
+}
 
-  bin &= ((npf_double_bin_t)0x1 << NPF_DOUBLE_MAN_BITS) - 1;
-  if (exp == (npf_ftoa_exp_t)NPF_DOUBLE_EXP_MASK) { // special value
-    ret = (bin) ? "NAN" : "FNI";
-    goto exit;
+static void npf_ftoa_tail_init(npf_ftoa_tail_t *t) {
+  t->int_left = t->dot = t->frac_left = 0;
+}
+
+// Loads the next integer chunk, or the next (up to 9) fraction digits, into dig.
+static void npf_ftoa_exact_load(npf_ftoa_tail_t *t) {
+  static uint32_t const pow5[] = { 1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125 };
+  uint32_t c;
+  int n = 9;
+  if (t->n_i) {
+    c = t->w[--t->n_i];
+  } else {
+    uint32_t *f = t->w + 3;
+    uint64_t carry = 0;
+    if (t->k < 9) { n = t->k; }
+    for (int i = 0; i < t->n_f; ++i) {
+      carry += (uint64_t)f[i] * pow5[n];
+      f[i] = (uint32_t)carry;
+      carry >>= 32;
+    }
+    if (carry) { f[t->n_f++] = (uint32_t)carry; }
+    t->k -= n;
+    int const i = t->k / 32, sh = t->k % 32;
+    c = 0;
+    if (i < t->n_f) { // else the digits are zeros
+      uint64_t top = f[i] >> sh;
+      if (i + 1 < t->n_f) { top |= (uint64_t)f[i + 1] << (32 - sh); }
+      c = (uint32_t)top;
+      f[i] &= ((uint32_t)0x1 << sh) - 1;
+      t->n_f = i + !!sh;
+    }
   }
-  if (spec->prec > (NANOPRINTF_CONVERSION_BUFFER_SIZE - 2)) { goto exit; }
-  if (exp) { // normal number
-    bin |= (npf_double_bin_t)0x1 << NPF_DOUBLE_MAN_BITS;
-  } else { // subnormal number
-    ++exp;
+  t->n_dig = n;
+  for (int i = 0; i < n; ++i, c /= 10) { t->dig[i] = (char)(c % 10); }
+}
+
+static int npf_ftoa_exact_fetch(npf_ftoa_tail_t *t) {
+  if (!t->n_dig) {
+    if (!t->n_i && !t->k) { return 0; } // the fraction ran out
+    npf_ftoa_exact_load(t);
   }
-  exp = (npf_ftoa_exp_t)(exp - NPF_DOUBLE_EXP_BIAS);
+  return t->dig[--t->n_dig];
+}
 
-  uint_fast8_t carry; carry = 0;
-  npf_ftoa_dec_t end, dec; dec = (npf_ftoa_dec_t)spec->prec;
-  if (dec || spec->alt_form) {
-    buf[dec++] = '.';
+// Rounds to nearest, ties to even, on everything after the last fetched digit.
+static int npf_ftoa_exact_round(npf_ftoa_tail_t *t) {
+  uint32_t const *f = t->w + 3;
+  uint32_t rest = 0;
+  int next = 0;
+  if (t->n_dig) {
+    next = t->dig[--t->n_dig];
+    while (t->n_dig) { rest |= (uint32_t)(unsigned char)t->dig[--t->n_dig]; }
+    for (int i = 0; i < t->n_f; ++i) { rest |= f[i]; }
+  } else if (t->k && (((t->k - 1) / 32) < t->n_f)) { // compare the fraction with 1/2
+    int const i = (t->k - 1) / 32, sh = (t->k - 1) % 32;
+    next = ((f[i] >> sh) & 0x1) ? 5 : 0;
+    rest = f[i] & (((uint32_t)0x1 << sh) - 1);
+    for (int j = 0; j < i; ++j) { rest |= f[j]; }
   }
+  if (next != 5) { return next > 5; }
+  return rest ? 1 : (t->last & 1);
+}
 
-  { // Integer part
-    npf_ftoa_man_t man_i;
+// Fetches the 9s after pend and the digit after them.
+static void npf_ftoa_exact_scan(npf_ftoa_tail_t *t) {
+  for (t->nines = 0; t->left; ++t->nines) {
+    --t->left;
+    t->last = npf_ftoa_exact_fetch(t);
+    if (t->last != 9) { t->look = t->last; return; }
+  }
+  t->look = -1;
+  t->up = npf_ftoa_exact_round(t);
+}
 
-    if (exp >= 0) {
-      int_fast8_t shift_i =
-        (int_fast8_t)((exp > NPF_FTOA_SHIFT_BITS) ? (int)NPF_FTOA_SHIFT_BITS : exp);
-      npf_ftoa_exp_t exp_i = (npf_ftoa_exp_t)(exp - shift_i);
-      shift_i = (int_fast8_t)(NPF_DOUBLE_MAN_BITS - shift_i);
-      man_i = (npf_ftoa_man_t)(bin >> shift_i);
+static char npf_ftoa_exact_digit(npf_ftoa_tail_t *t) {
+  if ((t->pend < 0) && !t->nines) {
+    t->pend = t->look;
+    npf_ftoa_exact_scan(t);
+  }
+  int const up = (t->look < 0) && t->up;
+  if (t->pend >= 0) {
+    char const c = (char)('0' + t->pend + up);
+    t->pend = -1;
+    return c;
+  }
+  --t->nines;
+  return up ? '0' : '9';
+}
 
-      if (exp_i) {
-        if (shift_i) {
-          carry = (bin >> (shift_i - 1)) & 0x1;
-        }
-        exp = NPF_DOUBLE_MAN_BITS; // invalidate the fraction part
-      }
+static char npf_ftoa_tail_next(npf_ftoa_tail_t *t) {
+  if (t->int_left) { --t->int_left; return npf_ftoa_exact_digit(t); }
+  if (t->dot) { t->dot = 0; return '.'; }
+  --t->frac_left;
+  return npf_ftoa_exact_digit(t);
+}
 
-      // Scale the exponent from base-2 to base-10.
-      for (; exp_i; --exp_i) {
-        if (!(man_i & ((npf_ftoa_man_t)0x1 << (NPF_FTOA_MAN_BITS - 1)))) {
-          man_i = (npf_ftoa_man_t)(man_i << 1);
-          man_i = (npf_ftoa_man_t)(man_i | carry); carry = 0;
-        } else {
-          if (dec >= NANOPRINTF_CONVERSION_BUFFER_SIZE) { goto exit; }
-          buf[dec++] = '0';
-          carry = (((uint_fast8_t)(man_i % 5) + carry) > 2);
-          man_i /= 5;
-        }
-      }
-    } else {
-      man_i = 0;
+// Prepares the digits of m * 2^e; everything is printed from the tail.
+static int npf_ftoa_exact_rev(npf_format_spec_t const *spec, uint64_t m, int e,
+                              npf_ftoa_tail_t *t) {
+  uint32_t *w = t->w;
+  uint64_t i = m;
+  t->k = t->n_f = 0;
+  if (e < 0) {
+    uint64_t f = m;
+    i = 0;
+    if (e > -64) {
+      i = m >> -e;
+      f = m & (((uint64_t)0x1 << -e) - 1);
+    }
+    if (f) {
+      for (t->k = -e; !(f & 0x1); f >>= 1) { --t->k; }
+      w[3] = (uint32_t)f;
+      w[4] = (uint32_t)(f >> 32);
+      t->n_f = w[4] ? 2 : 1;
     }
-    end = dec;
+  }
 
-    do { // Print the integer
-      if (end >= NANOPRINTF_CONVERSION_BUFFER_SIZE) { goto exit; }
-      buf[end++] = (char)('0' + (char)(man_i % 10));
-      man_i /= 10;
-    } while (man_i);
+  // Integer chunks, doubled up to 29 bits at a time into place.
+  w[0] = (uint32_t)(i % 1000000000u);
+  i /= 1000000000u;
+  w[1] = (uint32_t)(i % 1000000000u);
+  w[2] = (uint32_t)(i / 1000000000u);
+  int n = w[2] ? 3 : (w[1] ? 2 : 1);
+  for (int s; e > 0; e -= s) {
+    uint32_t carry = 0;
+    s = (e < 29) ? e : 29;
+    for (int j = 0; j < n; ++j) {
+      uint64_t const v = ((uint64_t)w[j] << s) + carry;
+      carry = (uint32_t)(v / 1000000000u);
+      w[j] = (uint32_t)(v - ((uint64_t)carry * 1000000000u));
+    }
+    if (carry) { w[n++] = carry; }
   }
 
-  { // Fraction part
-    npf_ftoa_man_t man_f;
-    npf_ftoa_dec_t dec_f = (npf_ftoa_dec_t)spec->prec;
+  uint32_t c = w[--n];
+  t->n_i = n;
+  t->n_dig = 0;
+  do { t->dig[t->n_dig++] = (char)(c % 10); c /= 10; } while (c);
+
+  t->int_left = t->n_dig + (9 * n);
+  t->dot = (spec->prec || spec->alt_form);
+  t->frac_left = spec->prec;
+  t->left = t->int_left + spec->prec;
+  t->pend = 0; // a leading '0', only printed if rounding carries into it
+  npf_ftoa_exact_scan(t);
+  if ((t->look < 0) && t->up) {
+    ++t->int_left;
+  } else {
+    t->pend = -1;
+  }
+  return 0;
+}
 
-    if (exp < NPF_DOUBLE_MAN_BITS) {
-      int_fast8_t shift_f = (int_fast8_t)((exp < 0) ? -1 : exp);
-      npf_ftoa_exp_t exp_f = (npf_ftoa_exp_t)(exp - shift_f);
-      npf_double_bin_t bin_f =
-        bin << ((NPF_DOUBLE_BIN_BITS - NPF_DOUBLE_MAN_BITS) + shift_f);
+#else
+// Everything after the integer digits of a converted float. npf_ftoa_tail_next
+// generates it one character at a time, so neither the precision nor the
+// magnitude of the value needs conversion buffer space.
+typedef struct npf_ftoa_tail {
+  npf_ftoa_man_t man_f; // fraction bits, the next digit is in the top nibble
+  int zeros_i;          // '0's after the integer digits
+  int dot;              // non-zero if the decimal separator is pending
+  int zeros_f;          // '0's leading the fraction
+  int left;             // fraction digits left, including zeros_f
+  int nines;            // the last 'nines' digits round up to '0', or -1
+} npf_ftoa_tail_t;
+
+static int npf_ftoa_tail_len(npf_ftoa_tail_t const *t) {
+  return t->zeros_i + t->dot + t->left;
+}
 
-      // This if-else statement can be completely optimized at compile time.
-      if (NPF_DOUBLE_BIN_BITS > NPF_FTOA_MAN_BITS) {
-        man_f = (npf_ftoa_man_t)(bin_f >> ((unsigned)(NPF_DOUBLE_BIN_BITS -
-                                                      NPF_FTOA_MAN_BITS) %
-                                           NPF_DOUBLE_BIN_BITS));
-        carry = (uint_fast8_t)((bin_f >> ((unsigned)(NPF_DOUBLE_BIN_BITS -
-                                                     NPF_FTOA_MAN_BITS - 1) %
-                                          NPF_DOUBLE_BIN_BITS)) & 0x1);
-      } else {
-        man_f = (npf_ftoa_man_t)((npf_ftoa_man_t)bin_f
-                                 << ((unsigned)(NPF_FTOA_MAN_BITS -
-                                                NPF_DOUBLE_BIN_BITS) % NPF_FTOA_MAN_BITS));
-        carry = 0;
-      }
+static char npf_ftoa_tail_next(npf_ftoa_tail_t *t) {
+  if (t->zeros_i) { --t->zeros_i; return '0'; }
+  if (t->dot) { t->dot = 0; return '.'; }
+  char d = '0';
+  --t->left;
+  if (t->zeros_f) {
+    --t->zeros_f;
+  } else {
+    d = (char)(d + (char)(t->man_f >> (NPF_FTOA_MAN_BITS - 4)));
+    t->man_f = (npf_ftoa_man_t)(t->man_f & ~((npf_ftoa_man_t)0xF << (NPF_FTOA_MAN_BITS - 4)));
+    t->man_f = (npf_ftoa_man_t)(t->man_f * 10);
+  }
+  if (t->left < t->nines) { return '0'; }
+  return (char)(d + (t->left == t->nines));
+}
+
+static void npf_ftoa_tail_init(npf_ftoa_tail_t *t) {
+  t->man_f = 0;
+  t->zeros_i = t->dot = t->zeros_f = t->left = 0;
+  t->nines = -1;
+}
+#endif
+
+static int npf_ftoa_str_rev(
+    char *buf, npf_format_spec_t const *spec, char const *s, npf_ftoa_tail_t *t) {
+  uint_fast8_t i;
+  for (i = 0; s[i]; ++i) { buf[i] = (char)(s[i] + spec->case_adjust); }
+  npf_ftoa_tail_init(t);
+  return (int)i;
+}
+
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 0
+// Writes the integer digits reversed into buf and describes the rest in *t.
+static int npf_ftoa_digits_rev(char *buf, npf_format_spec_t const *spec,
+                               npf_ftoa_parts_t const *p, npf_ftoa_tail_t *t) {
+  uint_fast8_t carry = p->carry_i;
+  npf_ftoa_man_t man_i = p->man_i;
+  int end = 0, int_at;
+  npf_ftoa_tail_init(t);
+  t->dot = (spec->prec || spec->alt_form);
+  t->left = spec->prec;
+
+  // Scale the integer exponent from base-2 to base-10.
+  for (npf_ftoa_exp_t exp_i = p->exp_i; exp_i; --exp_i) {
+    if (!(man_i & ((npf_ftoa_man_t)0x1 << (NPF_FTOA_MAN_BITS - 1)))) {
+      man_i = (npf_ftoa_man_t)(man_i << 1);
+      man_i = (npf_ftoa_man_t)(man_i | carry); carry = 0;
+    } else {
+      ++t->zeros_i;
+      carry = (((uint_fast8_t)(man_i % 5) + carry) > 2);
+      man_i /= 5;
+    }
+  }
 
-      // Scale the exponent from base-2 to base-10 and prepare the first digit.
-      for (uint_fast8_t digit = 0; dec_f && (exp_f < 4); ++exp_f) {
-        if ((man_f > ((npf_ftoa_man_t)-4 / 5)) || digit) {
-          carry = (uint_fast8_t)(man_f & 0x1);
-          man_f = (npf_ftoa_man_t)(man_f >> 1);
+  if (p->has_f) { // Fraction part
+    npf_ftoa_man_t man_f = p->man_f;
+    int dec_f = spec->prec;
+    npf_ftoa_exp_t exp_f = p->exp_f;
+    carry = p->carry_f;
+
+    // Scale the exponent from base-2 to base-10 and prepare the first digit.
+    for (uint_fast8_t digit = 0; dec_f && (exp_f < 4); ++exp_f) {
+      if ((man_f > ((npf_ftoa_man_t)-4 / 5)) || digit) {
+        carry = (uint_fast8_t)(man_f & 0x1);
+        man_f = (npf_ftoa_man_t)(man_f >> 1);
+      } else {
+        man_f = (npf_ftoa_man_t)(man_f * 5);
+        if (carry) { man_f = (npf_ftoa_man_t)(man_f + 3); carry = 0; }
+        if (exp_f < 0) {
+          ++t->zeros_f;
+          --dec_f;
         } else {
-          man_f = (npf_ftoa_man_t)(man_f * 5);
-          if (carry) { man_f = (npf_ftoa_man_t)(man_f + 3); carry = 0; }
-          if (exp_f < 0) {
-            buf[--dec_f] = '0';
-          } else {
-            ++digit;
-          }
+          ++digit;
         }
       }
-      man_f = (npf_ftoa_man_t)(man_f + carry);
-      carry = (exp_f >= 0);
-      dec = 0;
-    } else {
-      man_f = 0;
     }
-
-    if (dec_f) {
-      // Print the fraction
-      for (;;) {
-        buf[--dec_f] = (char)('0' + (char)(man_f >> (NPF_FTOA_MAN_BITS - 4)));
-        man_f = (npf_ftoa_man_t)(man_f & ~((npf_ftoa_man_t)0xF << (NPF_FTOA_MAN_BITS - 4)));
-        if (!dec_f) { break; }
-        man_f = (npf_ftoa_man_t)(man_f * 10);
+    man_f = (npf_ftoa_man_t)(man_f + carry);
+    carry = (exp_f >= 0);
+
+    // Small precisions take every fraction digit and the rounding bit from one
+    // 64-bit multiply and skip the streamed tail. This is the digit loop below
+    // unrolled, so the output is identical.
+    if ((NPF_FTOA_MAN_BITS <= 32) && spec->prec && (spec->prec <= NPF_FTOA_FAST_PREC)) {
+      uint_fast32_t pow10 = 1, frac = 0;
+      for (int i = 1; i < dec_f; ++i) { pow10 *= 10; }
+      if (dec_f) {
+        uint_fast64_t const digits = (uint_fast64_t)man_f * pow10;
+        frac = (uint_fast32_t)(digits >> ((NPF_FTOA_MAN_BITS - 4) % 64));
+        carry &= (uint_fast8_t)(digits >> ((NPF_FTOA_MAN_BITS - 5) % 64));
+        pow10 *= 10;
+      } else {
+        carry &= (uint_fast8_t)(man_f >> (NPF_FTOA_MAN_BITS - 1));
       }
-      man_f = (npf_ftoa_man_t)(man_f << 4);
+      frac += carry;
+      carry = (frac == pow10) && (dec_f == spec->prec); // every digit rolled over
+      for (; end < spec->prec; frac /= 10) { buf[end++] = (char)('0' + (char)(frac % 10)); }
+      if (t->dot) { buf[end++] = '.'; }
+      t->dot = t->zeros_f = t->left = 0;
+      goto print_integer;
+    }
+
+    t->man_f = man_f;
+
+    // Run the fraction digits ahead of time to find how far rounding carries.
+    int nines = 0;
+    for (; dec_f; man_f = (npf_ftoa_man_t)(man_f * 10)) {
+      nines = ((man_f >> (NPF_FTOA_MAN_BITS - 4)) == 9) ? (nines + 1) : 0;
+      man_f = (npf_ftoa_man_t)(man_f & ~((npf_ftoa_man_t)0xF << (NPF_FTOA_MAN_BITS - 4)));
+      if (!--dec_f) { man_f = (npf_ftoa_man_t)(man_f << 4); break; }
+      if (!man_f) { break; } // only '0's follow
     }
-    if (exp < NPF_DOUBLE_MAN_BITS) {
-      carry &= (uint_fast8_t)(man_f >> (NPF_FTOA_MAN_BITS - 1));
+    carry &= (uint_fast8_t)(man_f >> (NPF_FTOA_MAN_BITS - 1));
+    if (carry) {
+      t->nines = nines;
+      carry = (nines == spec->prec); // every fraction digit rolled over
+    }
+  }
+
+print_integer:
+  int_at = end;
+  if (NPF_FTOA_MAN_BITS > 64) {
+    // Wider than 64 bits: one wide division per 19 digits, 64-bit math for the rest.
+    while (man_i >> (64 % NPF_FTOA_MAN_BITS)) {
+      npf_ftoa_man_t const q = (npf_ftoa_man_t)(man_i / UINT64_C(10000000000000000000));
+      uint64_t r = (uint64_t)(man_i - (q * UINT64_C(10000000000000000000)));
+      for (int i = 0; i < 19; ++i, r /= 10) {
+        buf[end++] = (char)('0' + (char)(r % 10));
+      }
+      man_i = q;
     }
+    uint64_t u = (uint64_t)man_i;
+    do {
+      buf[end++] = (char)('0' + (char)(u % 10));
+      u /= 10;
+    } while (u);
+  } else {
+    do { // Print the integer
+      buf[end++] = (char)('0' + (char)(man_i % 10));
+      man_i /= 10;
+    } while (man_i);
   }
 
-  // Round the number
-  for (; carry; ++dec) {
-    if (dec >= NANOPRINTF_CONVERSION_BUFFER_SIZE) { goto exit; }
+  // Round the integer
+  for (int dec = int_at; carry; ++dec) {
     if (dec >= end) { buf[end++] = '0'; }
-    if (buf[dec] == '.') { continue; }
     carry = (buf[dec] == '9');
     buf[dec] = (char)(carry ? '0' : (buf[dec] + 1));
   }
 
-  return (int)end;
-exit:
-  if (!ret) { ret = "RRE"; }
-  uint_fast8_t i;
-  for (i = 0; ret[i]; ++i) { buf[i] = (char)(ret[i] + spec->case_adjust); }
-  return (int)i;
+  return end;
 }
+#endif
 
-#endif // NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS
+static int npf_ftoa_rev(char *buf, npf_format_spec_t const *spec, npf_ftoa_float_t f,
+                        npf_ftoa_tail_t *t) {
+  npf_double_bin_t bin;
+  npf_ftoa_exp_t exp;
+#ifdef NPF_FTOA_X87_EXTENDED
+  { // The exponent isn't adjacent to the significand; the padding bytes are skipped.
+    char const *src = (char const *)&f;
+    char *dst = (char *)&bin;
+    uint16_t sign_exp;
+    for (uint_fast8_t i = 0; i < sizeof(bin); ++i) { dst[i] = src[i]; }
+    dst = (char *)&sign_exp;
+    for (uint_fast8_t i = 0; i < sizeof(sign_exp); ++i) { dst[i] = src[sizeof(bin) + i]; }
+    exp = (npf_ftoa_exp_t)(sign_exp & NPF_DOUBLE_EXP_MASK);
+  }
+#else
+  { // Union-cast is UB pre-C11, compiler optimizes byte-copy loop.
+    char const *src = (char const *)&f;
+    char *dst = (char *)&bin;
+    for (uint_fast8_t i = 0; i < sizeof(f); ++i) { dst[i] = src[i]; }
+  }
 
-#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
-static int npf_bin_len(npf_uint_t u) {
-  // Return the length of the binary string format of 'u', preferring intrinsics.
-  if (!u) { return 1; }
+  // Unsigned -> signed int casting is IB and can raise a signal but generally doesn't.
+  exp = (npf_ftoa_exp_t)((npf_ftoa_exp_t)(bin >> NPF_DOUBLE_MAN_BITS) & NPF_DOUBLE_EXP_MASK);
+#endif
 
-#ifdef _MSC_VER // Win64, use _BSR64 for everything. If x86, use _BSR when non-large.
-  #ifdef _M_X64
-    #define NPF_HAVE_BUILTIN_CLZ
+  bin &= ((npf_double_bin_t)0x1 << NPF_DOUBLE_MAN_BITS) - 1;
+  if (exp == (npf_ftoa_exp_t)NPF_DOUBLE_EXP_MASK) { // special value
+    return npf_ftoa_str_rev(buf, spec, (bin) ? "NAN" : "FNI", t);
+  }
+  if (exp) { // normal number
+    bin |= (npf_double_bin_t)0x1 << NPF_DOUBLE_MAN_BITS;
+  } else { // subnormal number
+    ++exp;
+  }
+  exp = (npf_ftoa_exp_t)(exp - NPF_DOUBLE_EXP_BIAS);
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+  (void)buf;
+  return npf_ftoa_exact_rev(spec, (uint64_t)bin, (int)exp - NPF_DOUBLE_MAN_BITS, t);
+#else
+
+  npf_ftoa_parts_t p;
+  p.carry_i = 0;
+
+  if (exp >= 0) { // Integer part
+    int_fast8_t shift_i =
+      (int_fast8_t)((exp > NPF_FTOA_SHIFT_BITS) ? (int)NPF_FTOA_SHIFT_BITS : exp);
+    p.exp_i = (npf_ftoa_exp_t)(exp - shift_i);
+    shift_i = (int_fast8_t)(NPF_DOUBLE_MAN_BITS - shift_i);
+    p.man_i = (npf_ftoa_man_t)(bin >> shift_i);
+
+    if (p.exp_i) {
+      if (shift_i) {
+        p.carry_i = (bin >> (shift_i - 1)) & 0x1;
+      }
+      exp = NPF_DOUBLE_MAN_BITS; // invalidate the fraction part
+    }
+  } else {
+    p.man_i = 0;
+    p.exp_i = 0;
+  }
+
+  p.has_f = (exp < NPF_DOUBLE_MAN_BITS);
+  if (p.has_f) { // Fraction part
+    int_fast8_t shift_f = (int_fast8_t)((exp < 0) ? -1 : exp);
+    p.exp_f = (npf_ftoa_exp_t)(exp - shift_f);
+    npf_double_bin_t bin_f =
+      bin << ((NPF_DOUBLE_BIN_BITS - NPF_DOUBLE_MAN_BITS) + shift_f);
+
+    // This if-else statement can be completely optimized at compile time.
+    if (NPF_DOUBLE_BIN_BITS > NPF_FTOA_MAN_BITS) {
+      p.man_f = (npf_ftoa_man_t)(bin_f >> ((unsigned)(NPF_DOUBLE_BIN_BITS -
+                                                      NPF_FTOA_MAN_BITS) %
+                                           NPF_DOUBLE_BIN_BITS));
+      p.carry_f = (uint_fast8_t)((bin_f >> ((unsigned)(NPF_DOUBLE_BIN_BITS -
+                                                       NPF_FTOA_MAN_BITS - 1) %
+                                            NPF_DOUBLE_BIN_BITS)) & 0x1);
+    } else {
+      p.man_f = (npf_ftoa_man_t)((npf_ftoa_man_t)bin_f
+                                 << ((unsigned)(NPF_FTOA_MAN_BITS -
+                                                NPF_DOUBLE_BIN_BITS) % NPF_FTOA_MAN_BITS));
+      p.carry_f = 0;
+    }
+  } else {
+    p.man_f = 0;
+    p.exp_f = 0;
+    p.carry_f = 0;
+  }
+
+  return npf_ftoa_digits_rev(buf, spec, &p, t);
+#endif
+}
+
+#if NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS == 1
+#if (FLT_MANT_DIG != 24) || (FLT_MAX_EXP != 128)
+  #error float32 support requires float to be IEEE-754 binary32.
+#endif
+
+// npf_ftoa_rev for IEEE binary32 bits, with a 32-bit bin and an 8-bit exponent.
+static int npf_ftoa32_rev(char *buf, npf_format_spec_t const *spec, uint32_t bin,
+                          npf_ftoa_tail_t *t) {
+  int_fast16_t exp = (int_fast16_t)((bin >> NPF_FLOAT32_MAN_BITS) & NPF_FLOAT32_EXP_MASK);
+
+  bin &= ((uint32_t)0x1 << NPF_FLOAT32_MAN_BITS) - 1;
+  if (exp == NPF_FLOAT32_EXP_MASK) { // special value
+    return npf_ftoa_str_rev(buf, spec, (bin) ? "NAN" : "FNI", t);
+  }
+  if (exp) { // normal number
+    bin |= (uint32_t)0x1 << NPF_FLOAT32_MAN_BITS;
+  } else { // subnormal number
+    ++exp;
+  }
+  exp = (int_fast16_t)(exp - NPF_FLOAT32_EXP_BIAS);
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+  (void)buf;
+  return npf_ftoa_exact_rev(spec, bin, (int)exp - NPF_FLOAT32_MAN_BITS, t);
+#else
+
+  npf_ftoa_parts_t p;
+  p.carry_i = 0;
+
+  if (exp >= 0) { // Integer part
+    int_fast8_t shift_i =
+      (int_fast8_t)((exp > NPF_FTOA32_SHIFT_BITS) ? (int)NPF_FTOA32_SHIFT_BITS : exp);
+    p.exp_i = (npf_ftoa_exp_t)(exp - shift_i);
+    shift_i = (int_fast8_t)(NPF_FLOAT32_MAN_BITS - shift_i);
+    p.man_i = (npf_ftoa_man_t)(bin >> shift_i);
+
+    if (p.exp_i) {
+      if (shift_i) {
+        p.carry_i = (bin >> (shift_i - 1)) & 0x1;
+      }
+      exp = NPF_FLOAT32_MAN_BITS; // invalidate the fraction part
+    }
+  } else {
+    p.man_i = 0;
+    p.exp_i = 0;
+  }
+
+  p.has_f = (exp < NPF_FLOAT32_MAN_BITS);
+  if (p.has_f) { // Fraction part
+    int_fast8_t shift_f = (int_fast8_t)((exp < 0) ? -1 : exp);
+    p.exp_f = (npf_ftoa_exp_t)(exp - shift_f);
+    uint32_t bin_f = bin << ((NPF_FLOAT32_BIN_BITS - NPF_FLOAT32_MAN_BITS) + shift_f);
+
+    // This if-else statement can be completely optimized at compile time.
+    if (NPF_FLOAT32_BIN_BITS > NPF_FTOA_MAN_BITS) {
+      p.man_f = (npf_ftoa_man_t)(bin_f >> ((unsigned)(NPF_FLOAT32_BIN_BITS -
+                                                      NPF_FTOA_MAN_BITS) %
+                                           NPF_FLOAT32_BIN_BITS));
+      p.carry_f = (uint_fast8_t)((bin_f >> ((unsigned)(NPF_FLOAT32_BIN_BITS -
+                                                       NPF_FTOA_MAN_BITS - 1) %
+                                            NPF_FLOAT32_BIN_BITS)) & 0x1);
+    } else {
+      p.man_f = (npf_ftoa_man_t)((npf_ftoa_man_t)bin_f
+                                 << ((unsigned)(NPF_FTOA_MAN_BITS -
+                                                NPF_FLOAT32_BIN_BITS) % NPF_FTOA_MAN_BITS));
+      p.carry_f = 0;
+    }
+  } else {
+    p.man_f = 0;
+    p.exp_f = 0;
+    p.carry_f = 0;
+  }
+
+  return npf_ftoa_digits_rev(buf, spec, &p, t);
+#endif
+}
+
+// '-' if the binary32 value is below zero, same as (val < 0.) for doubles.
+static char npf_float32_sign(uint32_t bits, char prepend) {
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+  return (bits >> 31) ? '-' : prepend;
+#else
+  uint32_t const mag = bits & 0x7FFFFFFFu;
+  return ((bits >> 31) && mag && (mag <= 0x7F800000u)) ? '-' : prepend;
+#endif
+}
+#endif
+
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+// Like glibc, exact mode prints the sign of -0. and of negative NaNs.
+static char npf_ftoa_sign(npf_ftoa_float_t f, char prepend) {
+  npf_double_bin_t bin;
+  char const *src = (char const *)&f;
+  char *dst = (char *)&bin;
+  for (uint_fast8_t i = 0; i < sizeof(f); ++i) { dst[i] = src[i]; }
+  return (bin >> (NPF_DOUBLE_BIN_BITS - 1)) ? '-' : prepend;
+}
+#endif
+
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+// Converts the fixed-point value val / 2^q; q is clamped to the width of npf_uint_t.
+// Without a precision, every digit of the exact value is printed.
+static int npf_qtoa_rev(char *buf, npf_format_spec_t *spec, npf_uint_t val, int q,
+                        npf_ftoa_tail_t *t) {
+  int const uint_bits = (int)(sizeof(npf_uint_t) * CHAR_BIT);
+  q = (q < 0) ? 0 : ((q > uint_bits) ? uint_bits : q);
+  if (spec->prec_opt == NPF_FMT_SPEC_OPT_NONE) { // n fraction bits, n decimals
+    spec->prec = q;
+    for (npf_uint_t f = val; spec->prec && !(f & 0x1); f >>= 1) { --spec->prec; }
+  }
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+  (void)buf;
+  return npf_ftoa_exact_rev(spec, (uint64_t)val, -q, t);
+#else
+  npf_uint_t const man_max = (npf_uint_t)(npf_ftoa_man_t)-1;
+  npf_uint_t const i = (q < uint_bits) ? (val >> q) : 0;
+  int shift_i = 0;
+  while ((i >> shift_i) > man_max) { ++shift_i; }
+
+  npf_ftoa_parts_t p;
+  p.man_i = (npf_ftoa_man_t)(i >> shift_i);
+  p.exp_i = (npf_ftoa_exp_t)shift_i;
+  p.carry_i = shift_i ? (uint_fast8_t)((i >> (shift_i - 1)) & 0x1) : 0;
+  p.has_f = q && !shift_i; // a shifted integer part invalidates the fraction part
+  p.man_f = 0;
+  p.exp_f = 0;
+  p.carry_f = 0;
+  if (p.has_f) { // Left-align the fraction bits in man_f
+    npf_uint_t f = val & ((q < uint_bits) ? (((npf_uint_t)0x1 << q) - 1) : (npf_uint_t)-1);
+    while (!i && f && !(f >> (q - 1))) { // Below 1, leading zeros go to exp_f like floats
+      f = (npf_uint_t)(f << 1);
+      p.exp_f = (npf_ftoa_exp_t)(p.exp_f - 1);
+    }
+    if (q <= NPF_FTOA_MAN_BITS) {
+      p.man_f = (npf_ftoa_man_t)((npf_ftoa_man_t)f << (NPF_FTOA_MAN_BITS - q));
+    } else {
+      p.man_f = (npf_ftoa_man_t)(f >> (q - NPF_FTOA_MAN_BITS));
+      p.carry_f = (uint_fast8_t)((f >> (q - NPF_FTOA_MAN_BITS - 1)) & 0x1);
+    }
+  }
+  return npf_ftoa_digits_rev(buf, spec, &p, t);
+#endif
+}
+#endif
+
+#endif // NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS
+
+#if (NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1)
+static int npf_bin_len(npf_uint_t u) {
+  // Return the length of the binary string format of 'u', preferring intrinsics.
+  if (!u) { return 1; }
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  if (u >> 64) { return 64 + npf_bin_len(u >> 64); } // intrinsics stop at 64 bits
+#endif
+
+#ifdef _MSC_VER // Win64, use _BSR64 for everything. If x86, use _BSR when non-large.
+  #ifdef _M_X64
+    #define NPF_HAVE_BUILTIN_CLZ
     #define NPF_CLZ _BitScanReverse64
   #elif NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 0
     #define NPF_HAVE_BUILTIN_CLZ
@@ -703,7 +1791,8 @@ static int npf_bin_len(npf_uint_t u) {
 #elif NANOPRINTF_CLANG || NANOPRINTF_GCC_PAST_4_6
   #define NPF_HAVE_BUILTIN_CLZ
   #if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
-    #define NPF_CLZ(X) ((sizeof(long long) * CHAR_BIT) - (size_t)__builtin_clzll(X))
+    #define NPF_CLZ(X) \
+      ((sizeof(long long) * CHAR_BIT) - (size_t)__builtin_clzll((unsigned long long)(X)))
   #else
     #define NPF_CLZ(X) ((sizeof(long) * CHAR_BIT) - (size_t)__builtin_clzl(X))
   #endif
@@ -721,6 +1810,173 @@ static int npf_bin_len(npf_uint_t u) {
 }
 #endif
 
+#if (NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1)
+// The number of fraction digits that give ip 'sig' significant digits.
+static int npf_prefix_frac_len(npf_uint_t ip, int sig) {
+  for (; ip >= 10; ip /= 10) { --sig; }
+  --sig;
+  return (sig < 0) ? 0 : ((sig > 9) ? 9 : sig);
+}
+
+// Prints val with the largest SI (powers of 1000) or IEC (powers of 1024) prefix,
+// or nanoseconds in the largest time unit up to seconds, that leaves a non-zero
+// integer part. It's rounded half up to the precision's significant digits
+// (default 3); integer digits are never dropped.
+static int npf_prefix_rev(char *buf, npf_format_spec_t const *spec, npf_uint_t val) {
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+  static char const si[] = "kMGTPEZYRQ", iec[] = "KMGTPEZY";
+  int const is_iec = (spec->conv_spec == NPF_FMT_SPEC_CONV_IEC_PREFIX);
+  int const uint_bits = (int)(sizeof(npf_uint_t) * CHAR_BIT);
+  int s = 0;
+#else
+  int const is_iec = 0;
+#endif
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+  int const is_dur = (spec->conv_spec == NPF_FMT_SPEC_CONV_DURATION);
+#else
+  int const is_dur = 0;
+#endif
+  int const max_e = is_dur ? 3 : (is_iec ? 8 : 10);
+  npf_uint_t div = 1, ip = val, r = 0;
+  int e = 0, f = 0;
+  uint_fast32_t frac = 0;
+
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+  if (is_iec) { // every 10 bits of val is one more prefix
+    e = (npf_bin_len(val) - 1) / 10;
+    e = (e > max_e) ? max_e : e;
+    s = 10 * e;
+  } else
+#endif
+  {
+    for (npf_uint_t const top = val / 1000; (div <= top) && (e < max_e); ++e) { div *= 1000; }
+  }
+
+  if (e) {
+    int sig = 3;
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+    if (spec->prec_opt != NPF_FMT_SPEC_OPT_NONE) { sig = spec->prec; }
+#endif
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+    if (is_iec) {
+      ip = val >> s;
+      r = val & (((npf_uint_t)0x1 << s) - 1);
+      if (s > uint_bits - 4) { r >>= s - (uint_bits - 4); s = uint_bits - 4; } // r * 10 fits
+    } else
+#endif
+    {
+      ip = val / div;
+      r = val % div;
+    }
+
+    f = npf_prefix_frac_len(ip, sig);
+    uint_fast32_t pow10 = 1;
+    for (int i = 0; i < f; ++i, pow10 *= 10) { // decimal digits of the fraction r
+      frac *= 10;
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+      if (is_iec) {
+        r *= 10;
+        frac += (uint_fast32_t)(r >> s);
+        r &= ((npf_uint_t)0x1 << s) - 1;
+      } else
+#endif
+      if (div /= 10) {
+        frac += (uint_fast32_t)(r / div);
+        r %= div;
+      }
+    }
+    int up = (div && (r >= div - r));
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+    if (is_iec) { up = (int)((r >> (s - 1)) & 0x1); }
+#endif
+    if (up && (++frac == pow10)) { // rounding reached the integer part
+      frac = 0;
+      if ((++ip == (is_iec ? 1024u : 1000u)) && (e < max_e)) { ip = 1; ++e; }
+      f = npf_prefix_frac_len(ip, sig);
+    }
+  }
+
+  int n = 0;
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+  if (is_dur) { // "ns", "us", "ms", "s"
+    buf[n++] = 's';
+    if (e < 3) { buf[n++] = "num"[e]; }
+  }
+#endif
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+  if (e && !is_dur) {
+    if (is_iec) { buf[n++] = 'i'; }
+    buf[n++] = is_iec ? iec[e - 1] : si[e - 1];
+  }
+#endif
+  if (spec->alt_form) { buf[n++] = ' '; }
+  if (f) {
+    for (int i = 0; i < f; ++i, frac /= 10) { buf[n++] = (char)('0' + (char)(frac % 10)); }
+    buf[n++] = '.';
+  }
+  return n + npf_utoa_rev(ip, buf + n, 10, 0);
+}
+#endif
+
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+static void npf_put2(char *p, int v) {
+  p[0] = (char)('0' + v / 10);
+  p[1] = (char)('0' + v % 10);
+}
+
+// Renders ts->text and returns its length. The date, hour and minute are only
+// rendered again when ts->sec moves to another minute.
+static int npf_timestamp_render(npf_timestamp_t *ts, int prec) {
+  long long minute = ts->sec / 60;
+  int sec = (int)(ts->sec % 60);
+  if (sec < 0) { sec += 60; --minute; } // floor, for times before 1970
+
+  if (!ts->prefix_len || (minute != ts->minute)) {
+    long long days = minute / 1440;
+    int mod = (int)(minute % 1440);
+    if (mod < 0) { mod += 1440; --days; }
+
+    // Hinnant's civil_from_days: 400-year eras of years starting on March 1st.
+    long long const z = days + 719468;
+    long long const era = ((z >= 0) ? z : (z - 146096)) / 146097;
+    int const doe = (int)(z - era * 146097);
+    int const yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int const doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int const mp = (5 * doy + 2) / 153;
+    int const mon = (mp < 10) ? (mp + 3) : (mp - 9);
+    long long const year = yoe + era * 400 + (mon <= 2);
+
+    char *p = ts->text, digits[20];
+    unsigned long long y = (unsigned long long)year;
+    int n = 0;
+    if (year < 0) { *p++ = '-'; y = 0 - y; }
+    do { digits[n++] = (char)('0' + (char)(y % 10)); y /= 10; } while (y || (n < 4));
+    while (n) { *p++ = digits[--n]; }
+    *p++ = '-'; npf_put2(p, mon); p += 2;
+    *p++ = '-'; npf_put2(p, doy - (153 * mp + 2) / 5 + 1); p += 2;
+    *p++ = 'T'; npf_put2(p, mod / 60); p += 2;
+    *p++ = ':'; npf_put2(p, mod % 60); p += 2;
+    *p++ = ':';
+    ts->minute = minute;
+    ts->prefix_len = (int)(p - ts->text);
+  }
+
+  char *p = ts->text + ts->prefix_len;
+  npf_put2(p, sec); p += 2;
+  if (prec > 0) {
+    unsigned long frac = (unsigned long)ts->nsec % 1000000000u;
+    prec = (prec > 9) ? 9 : prec;
+    for (int i = prec; i < 9; ++i) { frac /= 10; }
+    *p++ = '.';
+    for (int i = prec; i--; frac /= 10) { p[i] = (char)('0' + (char)(frac % 10)); }
+    p += prec;
+  }
+  *p++ = 'Z';
+  return (int)(p - ts->text);
+}
+#endif
+
 static void npf_bufputc(int c, void *ctx) {
   npf_bufputc_ctx_t *bpc = (npf_bufputc_ctx_t *)ctx;
   if (bpc->cur < bpc->len) { bpc->dst[bpc->cur++] = (char)c; }
@@ -728,39 +1984,285 @@ static void npf_bufputc(int c, void *ctx) {
 
 static void npf_bufputc_nop(int c, void *ctx) { (void)c; (void)ctx; }
 
+#if NPF_HAVE_IOV
+static void npf_iov_putc_init(npf_iov_putc_ctx_t *ipc, npf_iovec_t *iov, int iov_len,
+                              char *scratch, size_t scratch_len) {
+  ipc->iov = iov;
+  ipc->iov_len = iov_len;
+  ipc->iov_cur = 0;
+  ipc->scratch = scratch;
+  ipc->scratch_len = scratch ? scratch_len : 0;
+  ipc->scratch_cur = 0;
+  ipc->full = 0;
+}
+
+static int npf_iov_append(npf_iov_putc_ctx_t *ipc, char const *s, size_t len) {
+  if (ipc->full) { return 0; }
+  if (ipc->iov_cur) { // Extend the previous segment if it ends where this one starts.
+    npf_iovec_t *prev = &ipc->iov[ipc->iov_cur - 1];
+    if (((char const *)prev->iov_base + prev->iov_len) == s) {
+      prev->iov_len += len;
+      return 1;
+    }
+  }
+  if (ipc->iov_cur == ipc->iov_len) { ipc->full = 1; return 0; }
+  ipc->iov[ipc->iov_cur].iov_base = s;
+  ipc->iov[ipc->iov_cur++].iov_len = len;
+  return 1;
+}
+
+static void npf_iov_putc(int c, void *ctx) {
+  npf_iov_putc_ctx_t *ipc = (npf_iov_putc_ctx_t *)ctx;
+  if (ipc->scratch_cur == ipc->scratch_len) { ipc->full = 1; return; }
+  char *dst = &ipc->scratch[ipc->scratch_cur];
+  *dst = (char)c;
+  if (npf_iov_append(ipc, dst, 1)) { ++ipc->scratch_cur; }
+}
+
+static void npf_iov_span(char const *s, int len, void *ctx) {
+  npf_iov_append((npf_iov_putc_ctx_t *)ctx, s, (size_t)len);
+}
+#endif
+
+#ifdef NANOPRINTF_DPRINTF
+static void npf_fd_flush(npf_fdputc_ctx_t *fpc) {
+  npf_iovec_t *iov = fpc->iov;
+  int cnt = fpc->ipc.iov_cur;
+  while (!fpc->err && cnt) { // writev(2) may accept less than asked for.
+    ptrdiff_t w = (ptrdiff_t)NANOPRINTF_DPRINTF_WRITEV(fpc->fd, iov, cnt);
+    if (w > 0) {
+      fpc->n += (int)w;
+      while (cnt && ((size_t)w >= iov->iov_len)) {
+        w -= (ptrdiff_t)iov->iov_len;
+        ++iov;
+        --cnt;
+      }
+      if (cnt) {
+        iov->iov_base = (char const *)iov->iov_base + w;
+        iov->iov_len -= (size_t)w;
+      }
+    } else if ((w == 0) || (errno != EINTR)) {
+      fpc->err = 1;
+    }
+  }
+  npf_iov_putc_init(&fpc->ipc, fpc->iov, NANOPRINTF_DPRINTF_IOV_COUNT, fpc->scratch,
+                    sizeof(fpc->scratch));
+}
+
+// Out of segments or scratch: write what's pending and retry into the empty sink.
+static void npf_fdputc(int c, void *ctx) {
+  npf_fdputc_ctx_t *fpc = (npf_fdputc_ctx_t *)ctx;
+  npf_iov_putc(c, &fpc->ipc);
+  if (fpc->ipc.full) {
+    npf_fd_flush(fpc);
+    if (!fpc->err) { npf_iov_putc(c, &fpc->ipc); }
+  }
+}
+
+static void npf_fd_span(char const *s, int len, void *ctx) {
+  npf_fdputc_ctx_t *fpc = (npf_fdputc_ctx_t *)ctx;
+  npf_iov_span(s, len, &fpc->ipc);
+  if (fpc->ipc.full) {
+    npf_fd_flush(fpc);
+    if (!fpc->err) { npf_iov_span(s, len, &fpc->ipc); }
+  }
+}
+#endif
+
+#ifdef NANOPRINTF_PPRINTF_EX
+static void npf_putc_ex_adapt(int c, void *ctx) {
+  npf_ex_putc_ctx_t *epc = (npf_ex_putc_ctx_t *)ctx;
+  if (epc->stop) { return; }
+  if (epc->pc(c, epc->ctx)) { epc->stop = 1; } else { ++epc->n; }
+}
+#endif
+
+#ifdef NANOPRINTF_SNPRINTF_TRUNC
+static void npf_bufputc_trunc(int c, void *ctx) {
+  npf_trunc_putc_ctx_t *tpc = (npf_trunc_putc_ctx_t *)ctx;
+  if (tpc->buf.cur < tpc->buf.len) {
+    tpc->buf.dst[tpc->buf.cur++] = (char)c;
+  } else {
+    tpc->full = 1;
+  }
+}
+#endif
+
+#ifdef NANOPRINTF_ASPRINTF_REALLOC
+static void npf_asputc(int c, void *ctx) {
+  npf_asputc_ctx_t *as = (npf_asputc_ctx_t *)ctx;
+  if (as->cur == as->len) { // full, grow geometrically and move off the stack
+    if (as->err) { return; }
+    size_t const len = as->len * 2;
+    char *const heap = (char *)NANOPRINTF_ASPRINTF_REALLOC(as->heap, len);
+    if (!heap) { as->err = 1; return; }
+    if (!as->heap) { for (size_t i = 0; i < as->cur; ++i) { heap[i] = as->dst[i]; } }
+    as->dst = as->heap = heap;
+    as->len = len;
+  }
+  as->dst[as->cur++] = (char)c;
+}
+#endif
+
 typedef struct npf_cnt_putc_ctx {
   npf_putc pc;
   void *ctx;
   int n;
+#if NPF_HAVE_SINK_STOP
+  int const *stop; // if non-NULL, formatting ends once the sink sets *stop
+#endif
+#if NPF_HAVE_IOV
+  void (*span)(char const *s, int len, void *ctx); // if non-NULL, takes literals + strings
+#endif
+#ifdef NANOPRINTF_PPRINTF_STATS
+  npf_stats_t *stats; // if non-NULL, collects npf_pprintf_stats details
+#endif
 } npf_cnt_putc_ctx_t;
 
+static void npf_cnt_putc_init(npf_cnt_putc_ctx_t *pc_cnt, npf_putc pc, void *ctx) {
+  pc_cnt->pc = pc;
+  pc_cnt->ctx = ctx;
+  pc_cnt->n = 0;
+#if NPF_HAVE_SINK_STOP
+  pc_cnt->stop = NULL;
+#endif
+#if NPF_HAVE_IOV
+  pc_cnt->span = NULL;
+#endif
+#ifdef NANOPRINTF_PPRINTF_STATS
+  pc_cnt->stats = NULL;
+#endif
+}
+
 static void npf_putc_cnt(int c, void *ctx) {
   npf_cnt_putc_ctx_t *pc_cnt = (npf_cnt_putc_ctx_t *)ctx;
   ++pc_cnt->n;
   pc_cnt->pc(c, pc_cnt->ctx); // sibling-call optimization
 }
 
-#define NPF_PUTC(VAL) do { npf_putc_cnt((int)(VAL), &pc_cnt); } while (0)
+#define NPF_PUTC(VAL) do { npf_putc_cnt((int)(VAL), pc_cnt); } while (0)
+
+// Long runs (padding, strings, float digits) check it per byte, not per directive.
+#if NPF_HAVE_SINK_STOP
+  #define NPF_STOPPED() (pc_cnt->stop && *pc_cnt->stop)
+#else
+  #define NPF_STOPPED() 0
+#endif
+
+#if NPF_HAVE_IOV
+static void npf_span_cnt(char const *s, int len, npf_cnt_putc_ctx_t *pc_cnt) {
+  if (!len) { return; }
+  pc_cnt->n += len;
+  pc_cnt->span(s, len, pc_cnt->ctx);
+}
+#endif
+
+#ifdef NANOPRINTF_PROFILE
+#ifdef NPF_PROFILE_CNTVCT
+static unsigned long long npf_profile_cntvct(void) {
+  unsigned long long t;
+  __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(t));
+  return t;
+}
+#endif
+
+#ifdef NANOPRINTF_PROFILE_CLOCK
+  #define NPF_PROFILE_NOW() ((unsigned long long)NANOPRINTF_PROFILE_CLOCK())
+#else
+  #define NPF_PROFILE_NOW() 0ull
+#endif
+
+static npf_profile_t npf_profile_state;
+
+static void npf_profile_record(
+    uint_fast8_t conv, int bytes, int pad_bytes, unsigned long long start) {
+  npf_profile_conv_t i;
+  switch (conv) {
+    case NPF_FMT_SPEC_CONV_PERCENT: i = NPF_PROFILE_CONV_PERCENT; break;
+    case NPF_FMT_SPEC_CONV_CHAR: i = NPF_PROFILE_CONV_CHAR; break;
+    case NPF_FMT_SPEC_CONV_STRING: i = NPF_PROFILE_CONV_STRING; break;
+    case NPF_FMT_SPEC_CONV_SIGNED_INT: i = NPF_PROFILE_CONV_SIGNED_INT; break;
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_BINARY: i = NPF_PROFILE_CONV_BINARY; break;
+#endif
+    case NPF_FMT_SPEC_CONV_OCTAL: i = NPF_PROFILE_CONV_OCTAL; break;
+    case NPF_FMT_SPEC_CONV_HEX_INT: i = NPF_PROFILE_CONV_HEX_INT; break;
+    case NPF_FMT_SPEC_CONV_UNSIGNED_INT: i = NPF_PROFILE_CONV_UNSIGNED_INT; break;
+    case NPF_FMT_SPEC_CONV_POINTER: i = NPF_PROFILE_CONV_POINTER; break;
+#if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_WRITEBACK: i = NPF_PROFILE_CONV_WRITEBACK; break;
+#endif
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_FLOAT_DEC: i = NPF_PROFILE_CONV_FLOAT_DEC; break;
+    case NPF_FMT_SPEC_CONV_FLOAT_SCI: i = NPF_PROFILE_CONV_FLOAT_SCI; break;
+    case NPF_FMT_SPEC_CONV_FLOAT_SHORTEST: i = NPF_PROFILE_CONV_FLOAT_SHORTEST; break;
+    case NPF_FMT_SPEC_CONV_FLOAT_HEX: i = NPF_PROFILE_CONV_FLOAT_HEX; break;
+#endif
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_FIXED_POINT:
+    case NPF_FMT_SPEC_CONV_UFIXED_POINT: i = NPF_PROFILE_CONV_FIXED_POINT; break;
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_SCALED_DEC:
+    case NPF_FMT_SPEC_CONV_USCALED_DEC: i = NPF_PROFILE_CONV_SCALED_DEC; break;
+#endif
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_SI_PREFIX:
+    case NPF_FMT_SPEC_CONV_IEC_PREFIX: i = NPF_PROFILE_CONV_UNIT_PREFIX; break;
+#endif
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_DURATION: i = NPF_PROFILE_CONV_DURATION; break;
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+    case NPF_FMT_SPEC_CONV_TIMESTAMP: i = NPF_PROFILE_CONV_TIMESTAMP; break;
+#endif
+    default: return;
+  }
+
+  npf_profile_counters_t *c = &npf_profile_state.conv[i];
+  ++c->count;
+  c->bytes += (unsigned long long)bytes;
+  c->pad_bytes += (unsigned long long)pad_bytes;
+  c->cycles += NPF_PROFILE_NOW() - start;
+}
+#endif
 
 #define NPF_EXTRACT(MOD, CAST_TO, EXTRACT_AS) \
   case NPF_FMT_SPEC_LEN_MOD_##MOD: val = (CAST_TO)va_arg(args, EXTRACT_AS); break
 
 #define NPF_WRITEBACK(MOD, TYPE) \
-  case NPF_FMT_SPEC_LEN_MOD_##MOD: *(va_arg(args, TYPE *)) = (TYPE)pc_cnt.n; break
+  case NPF_FMT_SPEC_LEN_MOD_##MOD: *(va_arg(args, TYPE *)) = (TYPE)pc_cnt->n; break
 
-int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
+static int npf_vpprintf_cnt(
+    npf_cnt_putc_ctx_t *pc_cnt, char const *format, va_list args) {
   npf_format_spec_t fs;
   char const *cur = format;
-  npf_cnt_putc_ctx_t pc_cnt;
-  pc_cnt.pc = pc;
-  pc_cnt.ctx = pc_ctx;
-  pc_cnt.n = 0;
 
   while (*cur) {
+    if (NPF_STOPPED()) { break; }
     int const fs_len = (*cur != '%') ? 0 : npf_parse_format_spec(cur, &fs);
+#if NPF_HAVE_IOV
+    if (!fs_len && pc_cnt->span) { // Pass the whole literal run through at once.
+      char const *lit = cur++;
+      while (*cur && (*cur != '%')) { ++cur; }
+      npf_span_cnt(lit, (int)(cur - lit), pc_cnt);
+      continue;
+    }
+#endif
+#ifdef NANOPRINTF_PPRINTF_STATS
+    if (pc_cnt->stats) {
+      if (fs_len) { ++pc_cnt->stats->directives; } else { ++pc_cnt->stats->literal_bytes; }
+    }
+#endif
     if (!fs_len) { NPF_PUTC(*cur++); continue; }
     cur += fs_len;
 
+#ifdef NANOPRINTF_PROFILE
+    int const prof_n = pc_cnt->n;
+    unsigned long long const prof_start = NPF_PROFILE_NOW();
+    int prof_pad = 0;
+#endif
+
     // Extract star-args immediately
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
     if (fs.field_width_opt == NPF_FMT_SPEC_OPT_STAR) {
@@ -777,10 +2279,31 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
       if (fs.prec < 0) { fs.prec_opt = NPF_FMT_SPEC_OPT_NONE; }
     }
 #endif
+#if (NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1)
+    int scale = 0; // fraction bits (%k, %K) or decimal digits (%D, %U)
+    switch (fs.conv_spec) {
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_FIXED_POINT:
+      case NPF_FMT_SPEC_CONV_UFIXED_POINT:
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_SCALED_DEC:
+      case NPF_FMT_SPEC_CONV_USCALED_DEC:
+#endif
+        scale = va_arg(args, int);
+        break;
+      default: break;
+    }
+#endif
 
     union { char cbuf_mem[NANOPRINTF_CONVERSION_BUFFER_SIZE]; npf_uint_t binval; } u;
     char *cbuf = u.cbuf_mem, sign_c = 0;
     int cbuf_len = 0, need_0x = 0;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+    npf_ftoa_tail_t ftoa_tail;
+    int ftoa_tail_len = 0; // float characters that follow cbuf, counted in cbuf_len
+#endif
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
     int field_pad = 0;
     char pad_c = 0;
@@ -815,6 +2338,24 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
 #endif
       } break;
 
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_TIMESTAMP: {
+        npf_timestamp_t *ts = va_arg(args, npf_timestamp_t *);
+        int prec = 0;
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+        if (fs.prec_opt != NPF_FMT_SPEC_OPT_NONE) { prec = fs.prec; }
+#endif
+        cbuf_len = npf_timestamp_render(ts, prec);
+        cbuf = ts->text;
+      } break;
+#endif
+
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_FIXED_POINT:
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_SCALED_DEC:
+#endif
       case NPF_FMT_SPEC_CONV_SIGNED_INT: {
         npf_int_t val = 0;
         switch (fs.length_modifier) {
@@ -828,12 +2369,40 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
           NPF_EXTRACT(LARGE_INTMAX, intmax_t, intmax_t);
           NPF_EXTRACT(LARGE_SIZET, npf_ssize_t, npf_ssize_t);
           NPF_EXTRACT(LARGE_PTRDIFFT, ptrdiff_t, ptrdiff_t);
+#endif
+#if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
+          NPF_EXTRACT(W8, int8_t, int);
+          NPF_EXTRACT(W16, int16_t, int);
+          NPF_EXTRACT(W32, int32_t, int32_t);
+#if NPF_WIDE_UINT == 1
+          NPF_EXTRACT(W64, int64_t, int64_t);
+#endif
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+          NPF_EXTRACT(LARGE_INT128, npf_int_t, npf_int_t);
 #endif
           default: break;
         }
 
         sign_c = (val < 0) ? '-' : fs.prepend;
 
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+        if (fs.conv_spec == NPF_FMT_SPEC_CONV_FIXED_POINT) {
+          npf_uint_t const mag = (npf_uint_t)val;
+          cbuf_len = npf_qtoa_rev(cbuf, &fs, (val < 0) ? (0 - mag) : mag, scale, &ftoa_tail);
+          ftoa_tail_len = npf_ftoa_tail_len(&ftoa_tail);
+          cbuf_len += ftoa_tail_len;
+          break;
+        }
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+        if (fs.conv_spec == NPF_FMT_SPEC_CONV_SCALED_DEC) {
+          npf_uint_t const mag = (npf_uint_t)val;
+          cbuf_len = npf_dtoa_rev(cbuf, &fs, (val < 0) ? (0 - mag) : mag, scale);
+          break;
+        }
+#endif
+
 #if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
         zero = !val;
@@ -855,6 +2424,19 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
 #endif
       case NPF_FMT_SPEC_CONV_OCTAL:
       case NPF_FMT_SPEC_CONV_HEX_INT:
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_UFIXED_POINT:
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_USCALED_DEC:
+#endif
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_SI_PREFIX:
+      case NPF_FMT_SPEC_CONV_IEC_PREFIX:
+#endif
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_DURATION:
+#endif
       case NPF_FMT_SPEC_CONV_UNSIGNED_INT: {
         npf_uint_t val = 0;
 
@@ -869,10 +2451,54 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
           NPF_EXTRACT(LARGE_INTMAX, uintmax_t, uintmax_t);
           NPF_EXTRACT(LARGE_SIZET, size_t, size_t);
           NPF_EXTRACT(LARGE_PTRDIFFT, size_t, size_t);
+#endif
+#if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
+          NPF_EXTRACT(W8, uint8_t, unsigned);
+          NPF_EXTRACT(W16, uint16_t, unsigned);
+          NPF_EXTRACT(W32, uint32_t, uint32_t);
+#if NPF_WIDE_UINT == 1
+          NPF_EXTRACT(W64, uint64_t, uint64_t);
+#endif
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+          NPF_EXTRACT(LARGE_INT128, npf_uint_t, npf_uint_t);
 #endif
           default: break;
         }
 
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+        if (fs.conv_spec == NPF_FMT_SPEC_CONV_UFIXED_POINT) {
+          sign_c = fs.prepend;
+          cbuf_len = npf_qtoa_rev(cbuf, &fs, val, scale, &ftoa_tail);
+          ftoa_tail_len = npf_ftoa_tail_len(&ftoa_tail);
+          cbuf_len += ftoa_tail_len;
+          break;
+        }
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+        if (fs.conv_spec == NPF_FMT_SPEC_CONV_USCALED_DEC) {
+          sign_c = fs.prepend;
+          cbuf_len = npf_dtoa_rev(cbuf, &fs, val, scale);
+          break;
+        }
+#endif
+#if (NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1) || \
+    (NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1)
+        if (
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+            (fs.conv_spec == NPF_FMT_SPEC_CONV_SI_PREFIX) ||
+            (fs.conv_spec == NPF_FMT_SPEC_CONV_IEC_PREFIX) ||
+#endif
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+            (fs.conv_spec == NPF_FMT_SPEC_CONV_DURATION) ||
+#endif
+            0) {
+          sign_c = fs.prepend;
+          cbuf_len = npf_prefix_rev(cbuf, &fs, val);
+          break;
+        }
+#endif
+
 #if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
         zero = !val;
@@ -927,6 +2553,17 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
           NPF_WRITEBACK(LARGE_INTMAX, intmax_t);
           NPF_WRITEBACK(LARGE_SIZET, size_t);
           NPF_WRITEBACK(LARGE_PTRDIFFT, ptrdiff_t);
+#endif
+#if NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS == 1
+          NPF_WRITEBACK(W8, int8_t);
+          NPF_WRITEBACK(W16, int16_t);
+          NPF_WRITEBACK(W32, int32_t);
+#if NPF_WIDE_UINT == 1
+          NPF_WRITEBACK(W64, int64_t);
+#endif
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+          NPF_WRITEBACK(LARGE_INT128, npf_int_t);
 #endif
           default: break;
         } break;
@@ -937,23 +2574,58 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
       case NPF_FMT_SPEC_CONV_FLOAT_SCI:
       case NPF_FMT_SPEC_CONV_FLOAT_SHORTEST:
       case NPF_FMT_SPEC_CONV_FLOAT_HEX: {
-        double val;
-        if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE) {
-          val = (double)va_arg(args, long double);
-        } else {
-          val = va_arg(args, double);
-        }
+#if NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS == 1
+        if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_SHORT) { // binary32 bits
+          uint32_t const bits = va_arg(args, uint32_t);
+          sign_c = npf_float32_sign(bits, fs.prepend);
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+          zero = !(bits & 0x7FFFFFFFu);
+#endif
+          cbuf_len = npf_ftoa32_rev(cbuf, &fs, bits, &ftoa_tail);
+        } else
+#endif
+        {
+          npf_ftoa_float_t val;
+          if (fs.length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG_DOUBLE) {
+            val = (npf_ftoa_float_t)va_arg(args, long double);
+          } else {
+            val = va_arg(args, double);
+          }
 
-        sign_c = (val < 0.) ? '-' : fs.prepend;
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+          sign_c = npf_ftoa_sign(val, fs.prepend);
+#else
+          sign_c = (val < 0.) ? '-' : fs.prepend;
+#endif
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
-        zero = (val == 0.);
+          zero = (val == 0.);
+#endif
+          cbuf_len = npf_ftoa_rev(cbuf, &fs, val, &ftoa_tail);
+        }
+        ftoa_tail_len = npf_ftoa_tail_len(&ftoa_tail);
+        cbuf_len += ftoa_tail_len;
+#if (NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1) && \
+    (NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1)
+        if (!ftoa_tail_len) { fs.leading_zero_pad = 0; } // glibc pads inf and nan with ' '
 #endif
-        cbuf_len = npf_ftoa_rev(cbuf, &fs, val);
       } break;
 #endif
       default: break;
     }
 
+#ifdef NANOPRINTF_PPRINTF_STATS
+    if (pc_cnt->stats && (cbuf == u.cbuf_mem)) { // strings don't use the buffer
+      int used = cbuf_len;
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+      used -= ftoa_tail_len;
+#endif
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+      if (fs.conv_spec == NPF_FMT_SPEC_CONV_BINARY) { used = (int)sizeof(u.binval); }
+#endif
+      pc_cnt->stats->max_cbuf_len = npf_max(pc_cnt->stats->max_cbuf_len, used);
+    }
+#endif
+
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
     // Compute the field width pad character
     if (fs.field_width_opt != NPF_FMT_SPEC_OPT_NONE) {
@@ -974,13 +2646,35 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
 
     // Compute the number of bytes to truncate or '0'-pad.
 #if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
-    if (fs.conv_spec != NPF_FMT_SPEC_CONV_STRING) {
+    switch (fs.conv_spec) {
+      case NPF_FMT_SPEC_CONV_STRING:
 #if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
-      // float precision is after the decimal point
-      if (fs.conv_spec != NPF_FMT_SPEC_CONV_FLOAT_DEC)
+      case NPF_FMT_SPEC_CONV_FLOAT_DEC: // float precision is after the decimal point
 #endif
-      { prec_pad = npf_max(0, fs.prec - cbuf_len); }
+#if NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_FIXED_POINT:
+      case NPF_FMT_SPEC_CONV_UFIXED_POINT:
+#endif
+#if NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_SCALED_DEC:
+      case NPF_FMT_SPEC_CONV_USCALED_DEC:
+#endif
+#if NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_SI_PREFIX: // significant digits
+      case NPF_FMT_SPEC_CONV_IEC_PREFIX:
+#endif
+#if NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_DURATION:
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+      case NPF_FMT_SPEC_CONV_TIMESTAMP: // fraction digits
+#endif
+        break;
+      default: prec_pad = npf_max(0, fs.prec - cbuf_len); break;
     }
+#ifdef NANOPRINTF_PROFILE
+    prof_pad += prec_pad;
+#endif
 #endif
 
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
@@ -991,6 +2685,9 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
     field_pad -= prec_pad;
 #endif
     field_pad = npf_max(0, field_pad);
+#ifdef NANOPRINTF_PROFILE
+    if (pad_c) { prof_pad += field_pad; }
+#endif
 
     // Apply right-justified field width if requested
     if (!fs.left_justified && pad_c) { // If leading zeros pad, sign goes first.
@@ -999,7 +2696,7 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
         // Pad byte is '0', write '0x' before '0' pad chars.
         if (need_0x) { NPF_PUTC('0'); NPF_PUTC(need_0x); }
       }
-      while (field_pad-- > 0) { NPF_PUTC(pad_c); }
+      while ((field_pad-- > 0) && !NPF_STOPPED()) { NPF_PUTC(pad_c); }
       // Pad byte is ' ', write '0x' after ' ' pad chars but before number.
       if ((pad_c != '0') && need_0x) { NPF_PUTC('0'); NPF_PUTC(need_0x); }
     } else
@@ -1007,35 +2704,66 @@ int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
     { if (need_0x) { NPF_PUTC('0'); NPF_PUTC(need_0x); } } // no pad, '0x' requested.
 
     // Write the converted payload
-    if (fs.conv_spec == NPF_FMT_SPEC_CONV_STRING) {
-      for (int i = 0; i < cbuf_len; ++i) { NPF_PUTC(cbuf[i]); }
+    if ((fs.conv_spec == NPF_FMT_SPEC_CONV_STRING)
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+        || (fs.conv_spec == NPF_FMT_SPEC_CONV_TIMESTAMP) // written forward
+#endif
+    ) {
+#if NPF_HAVE_IOV
+      // %T text lives in the caller's reusable cache, so only strings are spans.
+      if (pc_cnt->span && (fs.conv_spec == NPF_FMT_SPEC_CONV_STRING)) {
+        npf_span_cnt(cbuf, cbuf_len, pc_cnt);
+      } else
+#endif
+      { for (int i = 0; (i < cbuf_len) && !NPF_STOPPED(); ++i) { NPF_PUTC(cbuf[i]); } }
     } else {
       if (sign_c) { NPF_PUTC(sign_c); }
 #if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
-      while (prec_pad-- > 0) { NPF_PUTC('0'); } // int precision leads.
+      while ((prec_pad-- > 0) && !NPF_STOPPED()) { NPF_PUTC('0'); } // int precision leads.
 #endif
 #if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
       if (fs.conv_spec == NPF_FMT_SPEC_CONV_BINARY) {
         while (cbuf_len) { NPF_PUTC('0' + ((u.binval >> --cbuf_len) & 1)); }
       } else
 #endif
-      { while (cbuf_len-- > 0) { NPF_PUTC(cbuf[cbuf_len]); } } // payload is reversed
+      {
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+        cbuf_len -= ftoa_tail_len;
+#endif
+        while (cbuf_len-- > 0) { NPF_PUTC(cbuf[cbuf_len]); } // payload is reversed
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+        while ((ftoa_tail_len-- > 0) && !NPF_STOPPED()) {
+          NPF_PUTC(npf_ftoa_tail_next(&ftoa_tail));
+        }
+#endif
+      }
     }
 
 #if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
     if (fs.left_justified && pad_c) { // Apply left-justified field width
-      while (field_pad-- > 0) { NPF_PUTC(pad_c); }
+      while ((field_pad-- > 0) && !NPF_STOPPED()) { NPF_PUTC(pad_c); }
     }
 #endif
+
+#ifdef NANOPRINTF_PROFILE
+    npf_profile_record(fs.conv_spec, pc_cnt->n - prof_n, prof_pad, prof_start);
+#endif
   }
 
-  return pc_cnt.n;
+  return pc_cnt->n;
 }
 
 #undef NPF_PUTC
+#undef NPF_STOPPED
 #undef NPF_EXTRACT
 #undef NPF_WRITEBACK
 
+int npf_vpprintf(npf_putc pc, void *pc_ctx, char const *format, va_list args) {
+  npf_cnt_putc_ctx_t pc_cnt;
+  npf_cnt_putc_init(&pc_cnt, pc, pc_ctx);
+  return npf_vpprintf_cnt(&pc_cnt, format, args);
+}
+
 int npf_pprintf(npf_putc pc, void *pc_ctx, char const *format, ...) {
   va_list val;
   va_start(val, format);
@@ -1073,6 +2801,234 @@ int npf_vsnprintf(char *buffer, size_t bufsz, char const *format, va_list vlist)
   return n;
 }
 
+#if NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS == 1
+int npf_ftoa32(char *buffer, size_t bufsz, float f, int precision) {
+  npf_format_spec_t fs;
+  npf_parse_format_spec("%f", &fs);
+  if (precision >= 0) { fs.prec = precision; }
+
+  uint32_t bits; { // Union-cast is UB pre-C11, compiler optimizes byte-copy loop.
+    char const *src = (char const *)&f;
+    char *dst = (char *)&bits;
+    for (uint_fast8_t i = 0; i < sizeof(bits); ++i) { dst[i] = src[i]; }
+  }
+
+  char cbuf[NANOPRINTF_CONVERSION_BUFFER_SIZE];
+  npf_ftoa_tail_t tail;
+  int cbuf_len = npf_ftoa32_rev(cbuf, &fs, bits, &tail);
+  int tail_len = npf_ftoa_tail_len(&tail);
+  char const sign_c = npf_float32_sign(bits, 0);
+  int const n = cbuf_len + tail_len + !!sign_c;
+
+  npf_bufputc_ctx_t bufputc_ctx;
+  bufputc_ctx.dst = buffer;
+  bufputc_ctx.len = bufsz;
+  bufputc_ctx.cur = 0;
+
+  npf_putc const pc = buffer ? npf_bufputc : npf_bufputc_nop;
+  if (sign_c) { pc(sign_c, &bufputc_ctx); }
+  while (cbuf_len) { pc(cbuf[--cbuf_len], &bufputc_ctx); }
+  while (tail_len-- > 0) { pc(npf_ftoa_tail_next(&tail), &bufputc_ctx); }
+  pc('\0', &bufputc_ctx);
+
+  if (buffer && bufsz) {
+#ifdef NANOPRINTF_SNPRINTF_SAFE_EMPTY_STRING_ON_OVERFLOW
+    if (n >= (int)bufsz) { buffer[0] = '\0'; }
+#else
+    buffer[bufsz - 1] = '\0';
+#endif
+  }
+
+  return n;
+}
+#endif
+
+#ifdef NANOPRINTF_PPRINTF_EX
+int npf_pprintf_ex(npf_putc_ex pc, void *pc_ctx, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vpprintf_ex(pc, pc_ctx, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_vpprintf_ex(npf_putc_ex pc, void *pc_ctx, char const *format, va_list vlist) {
+  npf_ex_putc_ctx_t epc;
+  epc.pc = pc;
+  epc.ctx = pc_ctx;
+  epc.n = 0;
+  epc.stop = 0;
+
+  npf_cnt_putc_ctx_t pc_cnt;
+  npf_cnt_putc_init(&pc_cnt, npf_putc_ex_adapt, &epc);
+  pc_cnt.stop = &epc.stop;
+  npf_vpprintf_cnt(&pc_cnt, format, vlist);
+  return epc.n;
+}
+#endif
+
+#ifdef NANOPRINTF_PPRINTF_STATS
+int npf_pprintf_stats(
+    npf_putc pc, void *pc_ctx, npf_stats_t *stats, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vpprintf_stats(pc, pc_ctx, stats, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_vpprintf_stats(
+    npf_putc pc, void *pc_ctx, npf_stats_t *stats, char const *format, va_list vlist) {
+  stats->literal_bytes = 0;
+  stats->directives = 0;
+  stats->max_cbuf_len = 0;
+
+  npf_cnt_putc_ctx_t pc_cnt;
+  npf_cnt_putc_init(&pc_cnt, pc, pc_ctx);
+  pc_cnt.stats = stats;
+  int const n = npf_vpprintf_cnt(&pc_cnt, format, vlist);
+
+  stats->bytes = n;
+  stats->converted_bytes = n - stats->literal_bytes;
+  return n;
+}
+#endif
+
+#ifdef NANOPRINTF_DPRINTF
+int npf_dprintf(int fd, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vdprintf(fd, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_vdprintf(int fd, char const *format, va_list vlist) {
+  npf_fdputc_ctx_t fpc;
+  npf_iov_putc_init(&fpc.ipc, fpc.iov, NANOPRINTF_DPRINTF_IOV_COUNT, fpc.scratch,
+                    sizeof(fpc.scratch));
+  fpc.fd = fd;
+  fpc.err = 0;
+  fpc.n = 0;
+
+  npf_cnt_putc_ctx_t pc_cnt;
+  npf_cnt_putc_init(&pc_cnt, npf_fdputc, &fpc);
+  pc_cnt.stop = &fpc.err;
+  pc_cnt.span = npf_fd_span;
+  npf_vpprintf_cnt(&pc_cnt, format, vlist);
+  npf_fd_flush(&fpc);
+
+  return fpc.err ? -1 : fpc.n;
+}
+#endif
+
+#ifdef NANOPRINTF_IOVEC
+int npf_ioprintf(npf_iovec_t *iov, int *iovcnt, char *scratch, size_t scratch_sz,
+                 char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vioprintf(iov, iovcnt, scratch, scratch_sz, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_vioprintf(npf_iovec_t *iov, int *iovcnt, char *scratch, size_t scratch_sz,
+                  char const *format, va_list vlist) {
+  npf_iov_putc_ctx_t ipc;
+  npf_iov_putc_init(&ipc, iov, *iovcnt, scratch, scratch_sz);
+
+  npf_cnt_putc_ctx_t pc_cnt;
+  npf_cnt_putc_init(&pc_cnt, npf_iov_putc, &ipc);
+  pc_cnt.stop = &ipc.full;
+  pc_cnt.span = npf_iov_span;
+  int const n = npf_vpprintf_cnt(&pc_cnt, format, vlist);
+
+  *iovcnt = ipc.iov_cur;
+  return ipc.full ? -1 : n;
+}
+#endif
+
+#ifdef NANOPRINTF_SNPRINTF_TRUNC
+int npf_snprintf_trunc(
+    char *buffer, size_t bufsz, int *truncated, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vsnprintf_trunc(buffer, bufsz, truncated, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_vsnprintf_trunc(
+    char *buffer, size_t bufsz, int *truncated, char const *format, va_list vlist) {
+  npf_trunc_putc_ctx_t tpc;
+  tpc.buf.dst = buffer;
+  tpc.buf.len = (buffer && bufsz) ? (bufsz - 1) : 0; // reserve the null terminator
+  tpc.buf.cur = 0;
+  tpc.full = 0;
+
+  npf_cnt_putc_ctx_t pc_cnt;
+  npf_cnt_putc_init(&pc_cnt, npf_bufputc_trunc, &tpc);
+  pc_cnt.stop = &tpc.full;
+  npf_vpprintf_cnt(&pc_cnt, format, vlist);
+
+  if (buffer && bufsz) { buffer[tpc.buf.cur] = '\0'; }
+  if (truncated) { *truncated = tpc.full; }
+  return (int)tpc.buf.cur;
+}
+#endif
+
+#ifdef NANOPRINTF_ASPRINTF_REALLOC
+int npf_asprintf(char **strp, char const *format, ...) {
+  va_list val;
+  va_start(val, format);
+  int const rv = npf_vasprintf(strp, format, val);
+  va_end(val);
+  return rv;
+}
+
+int npf_vasprintf(char **strp, char const *format, va_list vlist) {
+  char stack_buf[NANOPRINTF_ASPRINTF_STACK_SIZE];
+  npf_asputc_ctx_t as;
+  as.dst = stack_buf;
+  as.heap = NULL;
+  as.len = sizeof(stack_buf);
+  as.cur = 0;
+  as.err = 0;
+
+  int const n = npf_vpprintf(npf_asputc, &as, format, vlist);
+  npf_asputc('\0', &as);
+
+  if (!as.err && !as.heap) { // Fit on the stack, make a single exact-size copy.
+    as.heap = (char *)NANOPRINTF_ASPRINTF_REALLOC(NULL, as.cur);
+    if (as.heap) {
+      for (size_t i = 0; i < as.cur; ++i) { as.heap[i] = stack_buf[i]; }
+    } else {
+      as.err = 1;
+    }
+  }
+
+  if (as.err) {
+    if (as.heap) { NANOPRINTF_ASPRINTF_FREE(as.heap); }
+    *strp = NULL;
+    return -1;
+  }
+
+  *strp = as.heap;
+  return n;
+}
+#endif
+
+#ifdef NANOPRINTF_PROFILE
+void npf_profile_snapshot(npf_profile_t *out) { *out = npf_profile_state; }
+
+void npf_profile_reset(void) {
+  for (int i = 0; i < NPF_PROFILE_CONV_COUNT; ++i) {
+    npf_profile_counters_t *c = &npf_profile_state.conv[i];
+    c->count = c->bytes = c->pad_bytes = c->cycles = 0;
+  }
+}
+#endif
+
 #if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
   #pragma GCC diagnostic pop
 #endif
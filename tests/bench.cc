@@ -0,0 +1,278 @@
+// Throughput benchmarks for nanoprintf against the system snprintf.
+// Not run as part of the build; invoke the npf_bench binary directly, or pass
+// --json to emit machine-readable results (used by build.py --bench).
+
+#ifdef _MSC_VER
+  #pragma warning(disable:4464) // relative include uses ..
+  #pragma warning(disable:4514) // unreferenced inline function removed
+  #pragma warning(disable:4710) // function not inlined
+  #pragma warning(disable:4711) // selected for inline
+  #pragma warning(disable:4996) // unsafe crt function
+  #pragma warning(disable:5039) // extern "c" throw
+  #pragma warning(disable:5045) // spectre mitigation
+#endif
+
+#include <cstdlib>
+#include <cstddef>
+
+#define NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS 0
+#define NANOPRINTF_ASPRINTF_REALLOC(PTR, SIZE) realloc((PTR), (SIZE))
+#define NANOPRINTF_ASPRINTF_FREE(PTR) free(PTR)
+#define NANOPRINTF_VISIBILITY_STATIC
+#define NANOPRINTF_IMPLEMENTATION
+#include "../nanoprintf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wc++98-compat-pedantic"
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+    #pragma GCC diagnostic ignored "-Wold-style-cast"
+    #pragma GCC diagnostic ignored "-Wexit-time-destructors"
+    #pragma GCC diagnostic ignored "-Wglobal-constructors"
+    #ifndef __APPLE__
+      #pragma GCC diagnostic ignored "-Wunsafe-buffer-usage"
+    #endif
+  #endif
+  #pragma GCC diagnostic ignored "-Wformat"
+  #pragma GCC diagnostic ignored "-Wformat-nonliteral"
+  #pragma GCC diagnostic ignored "-Wformat-security"
+#endif
+
+// Defined in bench_exact.cc, built with NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS.
+int npf_exact_snprintf(char *buffer, size_t bufsz, char const *format, ...);
+
+namespace {
+char s_buf[256];
+
+struct BufCtx {
+  char *dst;
+  size_t len;
+  size_t cur;
+};
+
+void buf_putc(int c, void *ctx) {
+  BufCtx *b = static_cast<BufCtx *>(ctx);
+  if (b->cur < b->len) { b->dst[b->cur++] = (char)c; }
+}
+
+// Formatters, each callable with a format string and its arguments.
+struct NpfSnprintf {
+  static constexpr char const *name = "npf_snprintf";
+  template <class... A> int operator()(char const *f, A... a) const {
+    return npf_snprintf(s_buf, sizeof(s_buf), f, a...);
+  }
+};
+
+struct NpfPprintf {
+  static constexpr char const *name = "npf_pprintf";
+  template <class... A> int operator()(char const *f, A... a) const {
+    BufCtx ctx{s_buf, sizeof(s_buf), 0};
+    return npf_pprintf(buf_putc, &ctx, f, a...);
+  }
+};
+
+struct NpfLength {
+  static constexpr char const *name = "npf_snprintf(NULL)";
+  template <class... A> int operator()(char const *f, A... a) const {
+    return npf_snprintf(nullptr, 0, f, a...);
+  }
+};
+
+struct NpfExact {
+  static constexpr char const *name = "npf_snprintf exact";
+  template <class... A> int operator()(char const *f, A... a) const {
+    return npf_exact_snprintf(s_buf, sizeof(s_buf), f, a...);
+  }
+};
+
+// Called through a pointer so the compiler can't fold literal formats into strcpy.
+int (*volatile s_libc_snprintf)(char *, size_t, char const *, ...) = snprintf;
+
+struct LibcSnprintf {
+  static constexpr char const *name = "libc snprintf";
+  template <class... A> int operator()(char const *f, A... a) const {
+    return s_libc_snprintf(s_buf, sizeof(s_buf), f, a...);
+  }
+};
+
+struct NpfAsprintf {
+  static constexpr char const *name = "npf_asprintf";
+  template <class... A> int operator()(char const *f, A... a) const {
+    char *s;
+    int const n = npf_asprintf(&s, f, a...);
+    free(s);
+    return n;
+  }
+};
+
+struct NpfTwoPass {
+  static constexpr char const *name = "npf two-pass";
+  template <class... A> int operator()(char const *f, A... a) const {
+    int const n = npf_snprintf(nullptr, 0, f, a...);
+    char *s = static_cast<char *>(malloc((size_t)n + 1));
+    npf_snprintf(s, (size_t)n + 1, f, a...);
+    free(s);
+    return n;
+  }
+};
+
+// Workloads, each formatting input 'i' of a small rotating set of values.
+int const s_ints[] = { 0, 7, -42, 1234, -99999, 2147483647, -2147483647, 65535 };
+unsigned long long const s_u64s[] = {
+  0ull, 0xffull, 0xdeadbeefull, 0x123456789abcdefull, 0xffffffffffffffffull,
+  0x8000000000000000ull, 0x1ull, 0xcafef00dd00dull };
+char const *const s_strs[] = {
+  "", "a", "short", "medium length", "a somewhat longer string", "x", "path/to/file", "ok" };
+double const s_small[] = { 1e-3, 2.5e-3, 0.0123, 0.5, 0.999, 0.0078125, 0.1, 0.3333 };
+double const s_mid[] = { 1.5, 12.25, 123.456, 1234.5678, 99999.99, 3.14159, 42.0, 8080.08 };
+double const s_large[] = { 1e9, 2.5e10, 1.2345e12, 9.87654321e14, 4.2e15, 1e13, 7.7e11, 3e9 };
+
+#define NPF_BENCH_IDX(ARR) ARR[i % (sizeof(ARR) / sizeof(ARR[0]))]
+
+template <class F> int w_literal(F const &f, unsigned) {
+  return f("The quick brown fox jumps over the lazy dog");
+}
+template <class F> int w_int(F const &f, unsigned i) {
+  int const v = NPF_BENCH_IDX(s_ints);
+  return f("%d %i %u %x %o", v, -v, (unsigned)v, (unsigned)v, (unsigned)v);
+}
+template <class F> int w_llx(F const &f, unsigned i) {
+  unsigned long long const v = NPF_BENCH_IDX(s_u64s);
+  return f("%llx %016llX", v, ~v);
+}
+template <class F> int w_str(F const &f, unsigned i) {
+  char const *s = NPF_BENCH_IDX(s_strs);
+  return f("[%-16s|%16s]", s, s);
+}
+template <class F> int w_float_small(F const &f, unsigned i) {
+  return f("%f", NPF_BENCH_IDX(s_small));
+}
+template <class F> int w_float_mid(F const &f, unsigned i) {
+  return f("%.3f", NPF_BENCH_IDX(s_mid));
+}
+template <class F> int w_float_large(F const &f, unsigned i) {
+  return f("%.2f", NPF_BENCH_IDX(s_large));
+}
+template <class F> int w_binary(F const &f, unsigned i) {
+  return f("%b", (unsigned)NPF_BENCH_IDX(s_u64s));
+}
+template <class F> int w_log_line(F const &f, unsigned i) {
+  return f("%llu [%08x] %-12s %5d %.3f\n", NPF_BENCH_IDX(s_u64s), (unsigned)i,
+           NPF_BENCH_IDX(s_strs), NPF_BENCH_IDX(s_ints), NPF_BENCH_IDX(s_mid));
+}
+
+#undef NPF_BENCH_IDX
+
+struct Result {
+  double p10, p50, p90; // ns per call
+  double bytes_per_call;
+};
+
+int const kWarmupSamples = 5;
+int const kSamples = 31;
+double const kSampleNs = 2e6;
+
+volatile int s_sink;
+
+template <class Fn> Result measure(Fn const &fn) {
+  using clock = std::chrono::steady_clock;
+
+  // Calibrate the number of calls per sample so each sample takes ~kSampleNs.
+  unsigned iters = 1;
+  for (;;) {
+    auto const start = clock::now();
+    for (unsigned i = 0; i < iters; ++i) { s_sink = fn(i); }
+    double const ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    if ((ns >= kSampleNs) || (iters >= (1u << 28))) { break; }
+    iters *= 2;
+  }
+
+  std::vector<double> samples;
+  long long bytes = 0;
+  for (int s = 0; s < kWarmupSamples + kSamples; ++s) {
+    int sum = 0;
+    auto const start = clock::now();
+    for (unsigned i = 0; i < iters; ++i) { sum += fn(i); }
+    double const ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    s_sink = sum;
+    if (s >= kWarmupSamples) {
+      samples.push_back(ns / iters);
+      bytes += sum;
+    }
+  }
+
+  std::sort(samples.begin(), samples.end());
+  auto const pct = [&](size_t p) { return samples[(samples.size() - 1) * p / 100]; };
+  return Result{pct(10), pct(50), pct(90),
+                (double)bytes / ((double)iters * (double)kSamples)};
+}
+
+bool s_json = false;
+bool s_first_row = true;
+
+void report(char const *workload, char const *impl, Result const &r) {
+  if (s_json) {
+    printf("%s\n  {\"workload\": \"%s\", \"impl\": \"%s\", \"p10\": %.2f, "
+           "\"p50\": %.2f, \"p90\": %.2f, \"bytes_per_call\": %.2f}",
+           s_first_row ? "" : ",", workload, impl, r.p10, r.p50, r.p90, r.bytes_per_call);
+    s_first_row = false;
+    return;
+  }
+  printf("%-12s %-20s %10.1f %10.1f %10.1f %10.1f\n", workload, impl, r.p50, r.p10,
+         r.p90, (r.bytes_per_call * 1e3) / r.p50);
+  fflush(stdout);
+}
+
+#define NPF_BENCH_RUN(WORKLOAD, IMPL) \
+  report(#WORKLOAD, IMPL::name, measure([](unsigned i) { return w_##WORKLOAD(IMPL{}, i); }))
+
+#define NPF_BENCH_WORKLOAD(WORKLOAD) \
+  NPF_BENCH_RUN(WORKLOAD, NpfSnprintf); \
+  NPF_BENCH_RUN(WORKLOAD, NpfPprintf); \
+  NPF_BENCH_RUN(WORKLOAD, NpfLength); \
+  NPF_BENCH_RUN(WORKLOAD, LibcSnprintf)
+
+#define NPF_BENCH_FLOAT_WORKLOAD(WORKLOAD) \
+  NPF_BENCH_WORKLOAD(WORKLOAD); \
+  NPF_BENCH_RUN(WORKLOAD, NpfExact)
+}
+
+int main(int argc, char **argv) {
+  s_json = (argc > 1) && !strcmp(argv[1], "--json");
+  if (s_json) {
+    printf("[");
+  } else {
+    printf("%-12s %-20s %10s %10s %10s %10s\n", "workload", "impl", "ns/call", "p10",
+           "p90", "MB/s");
+  }
+
+  NPF_BENCH_WORKLOAD(literal);
+  NPF_BENCH_WORKLOAD(int);
+  NPF_BENCH_WORKLOAD(llx);
+  NPF_BENCH_WORKLOAD(str);
+  NPF_BENCH_FLOAT_WORKLOAD(float_small);
+  NPF_BENCH_FLOAT_WORKLOAD(float_mid);
+  NPF_BENCH_FLOAT_WORKLOAD(float_large);
+  NPF_BENCH_WORKLOAD(binary);
+  NPF_BENCH_WORKLOAD(log_line);
+
+  // Heap strings: single-pass npf_asprintf vs measuring + allocating + formatting.
+  NPF_BENCH_RUN(log_line, NpfAsprintf);
+  NPF_BENCH_RUN(log_line, NpfTwoPass);
+
+  if (s_json) { printf("\n]\n"); }
+  return 0;
+}
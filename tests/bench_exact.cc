@@ -0,0 +1,34 @@
+// nanoprintf with NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS, in its own
+// translation unit so bench.cc can time it next to the default float conversion.
+
+#ifdef _MSC_VER
+  #pragma warning(disable:4464) // relative include uses ..
+  #pragma warning(disable:4514) // unreferenced inline function removed
+  #pragma warning(disable:4710) // function not inlined
+  #pragma warning(disable:4711) // selected for inline
+  #pragma warning(disable:5045) // spectre mitigation
+#endif
+
+#include <cstdarg>
+#include <cstddef>
+
+#define NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS 0
+#define NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_VISIBILITY_STATIC
+#define NANOPRINTF_IMPLEMENTATION
+#include "../nanoprintf.h"
+
+int npf_exact_snprintf(char *buffer, size_t bufsz, char const *format, ...);
+
+int npf_exact_snprintf(char *buffer, size_t bufsz, char const *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int const n = npf_vsnprintf(buffer, bufsz, format, args);
+  va_end(args);
+  return n;
+}
@@ -0,0 +1,269 @@
+// Measures nanoprintf's peak stack use. Each case runs on its own ucontext
+// stack, painted with a known byte beforehand; the deepest overwritten byte
+// gives the high-water mark. A no-op case with the same call shape is
+// subtracted, so the harness's own frames aren't counted.
+
+#define _XOPEN_SOURCE 700
+
+#include <float.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ucontext.h>
+#ifdef NANOPRINTF_DPRINTF
+  #include <fcntl.h>
+#endif
+
+#define NANOPRINTF_IMPLEMENTATION
+#include "../nanoprintf.h"
+
+#if defined(__clang__) || defined(__GNUC__)
+  #pragma GCC diagnostic ignored "-Wformat" // %b, %w128 and %T aren't standard
+  #pragma GCC diagnostic ignored "-Wformat-extra-args"
+#endif
+
+// Peak bytes allowed for this configuration: the base cost plus what each enabled
+// feature adds, measured with x86-64 GCC 12 at -Os and -O0, plus headroom. With
+// that compiler, a regression larger than the headroom fails; other compilers and
+// targets weren't measured, so they get more. Precision, large and binary
+// specifiers, writeback and native long double fit in the base and float costs.
+#ifndef NPF_STACK_BUDGET
+  #ifdef __OPTIMIZE__
+    #define NPF_STACK_BASE 472
+    #define NPF_STACK_FIELD_WIDTH 48
+    #define NPF_STACK_FLOAT 56
+    #define NPF_STACK_EXACT_FLOAT 264
+    #define NPF_STACK_INT128 104
+    #define NPF_STACK_TIMESTAMP 32
+    #define NPF_STACK_DPRINTF 400
+  #else // unoptimized builds spill far more locals
+    #define NPF_STACK_BASE 740
+    #define NPF_STACK_FIELD_WIDTH 48
+    #define NPF_STACK_FLOAT 228
+    #define NPF_STACK_EXACT_FLOAT 120
+    #define NPF_STACK_INT128 80
+    #define NPF_STACK_TIMESTAMP 0
+    #define NPF_STACK_DPRINTF 224
+  #endif
+  #if defined(__GNUC__) && (__GNUC__ == 12) && defined(__x86_64__) && !defined(__clang__)
+    #define NPF_STACK_HEADROOM 64
+  #else
+    #define NPF_STACK_HEADROOM 192
+  #endif
+  #ifdef NANOPRINTF_DPRINTF
+    #define NPF_STACK_USE_DPRINTF 1
+  #else
+    #define NPF_STACK_USE_DPRINTF 0
+  #endif
+  #define NPF_STACK_BUDGET (NPF_STACK_BASE + NPF_STACK_HEADROOM + \
+    NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS * NPF_STACK_FIELD_WIDTH + \
+    NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS * NPF_STACK_FLOAT + \
+    NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS * NPF_STACK_EXACT_FLOAT + \
+    NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS * NPF_STACK_INT128 + \
+    NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS * NPF_STACK_TIMESTAMP + \
+    NPF_STACK_USE_DPRINTF * NPF_STACK_DPRINTF)
+#endif
+
+#define NPF_STACK_SIZE (64 * 1024)
+#define NPF_STACK_PAINT 0xA5
+
+typedef struct npf_stack_case {
+  char const *name;
+  int (*run)(char *buf, size_t len);
+} npf_stack_case_t;
+
+static int case_noop(char *buf, size_t len) { (void)buf; return (int)len; }
+
+static int case_int_min(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%d", INT_MIN);
+}
+static int case_uint_alt(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%#o %#X %u", UINT_MAX, UINT_MAX, UINT_MAX);
+}
+static int case_long(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%ld %lx", LONG_MIN, ULONG_MAX);
+}
+static int case_pointer(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%p", (void *)buf);
+}
+static int case_str_char(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%s%c%%", "hello", 'x');
+}
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+static int case_wide_fields(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%-*s|%0*d|%*x", 100, "s", 100, -1, -100, 1u);
+}
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+static int case_long_precision(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%.*d|%.*s", 100, INT_MIN, 100, "s");
+}
+#endif
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+static int case_large(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%lld %#llo %jx %zu %td",
+                      LLONG_MIN, ULLONG_MAX, UINTMAX_MAX, SIZE_MAX, PTRDIFF_MIN);
+}
+#endif
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+static int case_binary(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%#b", UINT_MAX);
+}
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+static int case_binary_large(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%llb", ULLONG_MAX);
+}
+#endif
+#endif
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+static int case_float_huge(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%f %f", DBL_MAX, -DBL_MAX);
+}
+static int case_float_tiny(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%.*f %f", NANOPRINTF_CONVERSION_BUFFER_SIZE - 3,
+                      DBL_MIN, 4.9406564584124654e-324); // smallest subnormal
+}
+static int case_float_long_precision(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%.*f %Lf", 100, 1.5, (long double)1e15);
+}
+#endif
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+static int case_float_exact(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%f %.1074f", DBL_MAX, 4.9406564584124654e-324);
+}
+#endif
+#if NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS == 1
+static int case_long_double(char *buf, size_t len) {
+  return npf_snprintf(buf, len, "%Lf %.*Lf", LDBL_MAX, 100, LDBL_MIN);
+}
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+__extension__ typedef __int128 npf_i128_t;
+__extension__ typedef unsigned __int128 npf_u128_t;
+static int case_int128(char *buf, size_t len) {
+  npf_i128_t const min = (npf_i128_t)((npf_u128_t)1 << 127);
+  return npf_snprintf(buf, len, "%w128d %#w128o %w128b", min, min, min);
+}
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+static int case_timestamp(char *buf, size_t len) {
+  npf_timestamp_t ts;
+  memset(&ts, 0, sizeof(ts));
+  ts.sec = LLONG_MIN;
+  ts.nsec = 999999999;
+  return npf_snprintf(buf, len, "%.9T", &ts);
+}
+#endif
+#ifdef NANOPRINTF_DPRINTF
+static int s_null_fd = -1;
+static int case_dprintf(char *buf, size_t len) {
+  (void)buf; // longer than the buffer, so it's flushed mid-line
+  return npf_dprintf(s_null_fd, "%s %-*d|", "line", (int)len * 4, INT_MIN);
+}
+#endif
+#if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
+static int case_writeback(char *buf, size_t len) {
+  int n;
+  return npf_snprintf(buf, len, "abc%n", &n) + n;
+}
+#endif
+
+static npf_stack_case_t const s_cases[] = {
+  { "int min", case_int_min },
+  { "unsigned alt forms", case_uint_alt },
+  { "long", case_long },
+  { "pointer", case_pointer },
+  { "string + char", case_str_char },
+#if NANOPRINTF_USE_FIELD_WIDTH_FORMAT_SPECIFIERS == 1
+  { "wide fields", case_wide_fields },
+#endif
+#if NANOPRINTF_USE_PRECISION_FORMAT_SPECIFIERS == 1
+  { "long precision", case_long_precision },
+#endif
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+  { "large integers", case_large },
+#endif
+#if NANOPRINTF_USE_BINARY_FORMAT_SPECIFIERS == 1
+  { "binary", case_binary },
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+  { "large binary", case_binary_large },
+#endif
+#endif
+#if NANOPRINTF_USE_FLOAT_FORMAT_SPECIFIERS == 1
+  { "huge doubles", case_float_huge },
+  { "tiny doubles", case_float_tiny },
+  { "float long precision", case_float_long_precision },
+#endif
+#if NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS == 1
+  { "exact doubles", case_float_exact },
+#endif
+#if NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS == 1
+  { "long doubles", case_long_double },
+#endif
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+  { "128-bit integers", case_int128 },
+#endif
+#if NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS == 1
+  { "timestamp", case_timestamp },
+#endif
+#ifdef NANOPRINTF_DPRINTF
+  { "dprintf", case_dprintf },
+#endif
+#if NANOPRINTF_USE_WRITEBACK_FORMAT_SPECIFIERS == 1
+  { "writeback", case_writeback },
+#endif
+};
+
+static union { unsigned char bytes[NPF_STACK_SIZE]; long double align; } s_stack;
+static ucontext_t s_main_ctx, s_case_ctx;
+static npf_stack_case_t const *s_cur;
+static char s_buf[64];
+
+static void run_current_case(void) {
+  int (*volatile run)(char *, size_t) = s_cur->run; // keep the call out-of-line
+  run(s_buf, sizeof(s_buf));
+}
+
+static void run_on_stack(void) {
+  getcontext(&s_case_ctx);
+  s_case_ctx.uc_stack.ss_sp = s_stack.bytes;
+  s_case_ctx.uc_stack.ss_size = sizeof(s_stack.bytes);
+  s_case_ctx.uc_link = &s_main_ctx;
+  makecontext(&s_case_ctx, run_current_case, 0);
+  swapcontext(&s_main_ctx, &s_case_ctx);
+}
+
+static int measure(npf_stack_case_t const *c) {
+  s_cur = c;
+  run_on_stack(); // Warm up first, lazy symbol binding can use kilobytes of stack.
+  memset(s_stack.bytes, NPF_STACK_PAINT, sizeof(s_stack.bytes));
+  run_on_stack();
+
+  size_t i = 0; // Stacks grow down, the first overwritten byte is the high-water mark.
+  while ((i < sizeof(s_stack.bytes)) && (s_stack.bytes[i] == NPF_STACK_PAINT)) { ++i; }
+  return (int)(sizeof(s_stack.bytes) - i);
+}
+
+int main(void) {
+  npf_stack_case_t const noop = { "noop", case_noop };
+#ifdef NANOPRINTF_DPRINTF
+  s_null_fd = open("/dev/null", O_WRONLY);
+  if (s_null_fd < 0) { printf("FAIL: can't open /dev/null\n"); return 1; }
+#endif
+  int const base = measure(&noop);
+  int peak = 0;
+
+  for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); ++i) {
+    int const used = measure(&s_cases[i]) - base;
+    printf("%-22s %5d bytes\n", s_cases[i].name, used);
+    if (used > peak) { peak = used; }
+  }
+
+  printf("%-22s %5d bytes (budget %d)\n", "peak", peak, NPF_STACK_BUDGET);
+  if (peak > NPF_STACK_BUDGET) {
+    printf("FAIL: peak stack use exceeds the budget\n");
+    return 1;
+  }
+  return 0;
+}
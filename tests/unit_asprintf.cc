@@ -0,0 +1,77 @@
+#include <cstdlib>
+#include <cstddef>
+
+namespace {
+int s_allocs, s_frees, s_fail_after = -1;
+
+void *test_realloc(void *p, size_t n) {
+  if (s_fail_after >= 0 && s_allocs >= s_fail_after) { return nullptr; }
+  ++s_allocs;
+  return realloc(p, n);
+}
+
+void test_free(void *p) { ++s_frees; free(p); }
+}
+
+#define NANOPRINTF_ASPRINTF_REALLOC(PTR, SIZE) test_realloc((PTR), (SIZE))
+#define NANOPRINTF_ASPRINTF_FREE(PTR) test_free(PTR)
+#define NANOPRINTF_ASPRINTF_STACK_SIZE 8
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+  #endif
+  #pragma GCC diagnostic ignored "-Wformat-zero-length"
+#endif
+
+TEST_CASE("npf_asprintf") {
+  char *s = nullptr;
+  s_allocs = s_frees = 0;
+  s_fail_after = -1;
+
+  SUBCASE("empty string") {
+    REQUIRE(npf_asprintf(&s, "") == 0);
+    REQUIRE(s);
+    REQUIRE(std::string{s}.empty());
+    REQUIRE(s_allocs == 1);
+  }
+
+  SUBCASE("fits in stack buffer allocates once") {
+    REQUIRE(npf_asprintf(&s, "%d%s", 12, "abc") == 5);
+    REQUIRE(std::string{s} == "12abc");
+    REQUIRE(s_allocs == 1);
+  }
+
+  SUBCASE("exact fit with null terminator stays on the stack") {
+    REQUIRE(npf_asprintf(&s, "1234567") == 7);
+    REQUIRE(std::string{s} == "1234567");
+    REQUIRE(s_allocs == 1);
+  }
+
+  SUBCASE("outgrowing the stack buffer grows geometrically") {
+    std::string const expected(100, 'x');
+    REQUIRE(npf_asprintf(&s, "%s", expected.c_str()) == 100);
+    REQUIRE(std::string{s} == expected);
+    REQUIRE(s_allocs == 4); // 16, 32, 64, 128
+  }
+
+  SUBCASE("allocation failure on the exact-size copy") {
+    s_fail_after = 0;
+    REQUIRE(npf_asprintf(&s, "abc") == -1);
+    REQUIRE(s == nullptr);
+    REQUIRE(s_frees == 0);
+  }
+
+  SUBCASE("allocation failure while growing frees the partial string") {
+    s_fail_after = 2;
+    REQUIRE(npf_asprintf(&s, "%s", std::string(100, 'y').c_str()) == -1);
+    REQUIRE(s == nullptr);
+    REQUIRE(s_frees == 1);
+  }
+
+  free(s);
+}
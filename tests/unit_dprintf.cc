@@ -0,0 +1,105 @@
+#include <cerrno>
+#include <cstddef>
+#include <string>
+
+namespace {
+struct FakeFd {
+  std::string written;
+  size_t max_per_write = 1000;
+  int eintr_count = 0;
+  int fail_after_writes = -1;
+  int writes = 0;
+};
+
+FakeFd s_fds[2];
+
+}
+
+long fake_writev(int fd, struct npf_iovec const *iov, int cnt);
+
+#define NANOPRINTF_DPRINTF
+#define NANOPRINTF_DPRINTF_BUFFER_SIZE 16
+#define NANOPRINTF_DPRINTF_IOV_COUNT 8
+#define NANOPRINTF_DPRINTF_WRITEV(FD, IOV, CNT) fake_writev((FD), (IOV), (CNT))
+#include "unit_nanoprintf.h"
+
+long fake_writev(int fd, npf_iovec_t const *iov, int cnt) {
+  FakeFd &f = s_fds[fd];
+  if (f.eintr_count) { --f.eintr_count; errno = EINTR; return -1; }
+  if ((f.fail_after_writes >= 0) && (f.writes >= f.fail_after_writes)) {
+    errno = EIO;
+    return -1;
+  }
+  ++f.writes;
+  size_t n = 0;
+  for (int i = 0; (i < cnt) && (n < f.max_per_write); ++i) {
+    size_t const left = f.max_per_write - n;
+    size_t const len = (iov[i].iov_len < left) ? iov[i].iov_len : left;
+    f.written.append(static_cast<char const *>(iov[i].iov_base), len);
+    n += len;
+  }
+  return (long)n;
+}
+
+TEST_CASE("npf_dprintf") {
+  s_fds[0] = FakeFd{};
+  s_fds[1] = FakeFd{};
+
+  SUBCASE("empty string never writes") {
+    REQUIRE(npf_dprintf(1, "%s", "") == 0);
+    REQUIRE(s_fds[1].writes == 0);
+  }
+
+  SUBCASE("short line is a single write") {
+    REQUIRE(npf_dprintf(1, "%s=%d\n", "x", 42) == 5);
+    REQUIRE(s_fds[1].written == "x=42\n");
+    REQUIRE(s_fds[1].writes == 1);
+  }
+
+  SUBCASE("writes go to the requested descriptor") {
+    REQUIRE(npf_dprintf(0, "abc") == 3);
+    REQUIRE(s_fds[0].written == "abc");
+    REQUIRE(s_fds[1].written.empty());
+  }
+
+  SUBCASE("long strings don't use the buffer, so the line is a single write") {
+    std::string const s(200, 's');
+    REQUIRE(npf_dprintf(1, "[%s] %d\n", s.c_str(), 42) == 206);
+    REQUIRE(s_fds[1].written == "[" + s + "] 42\n");
+    REQUIRE(s_fds[1].writes == 1);
+  }
+
+  SUBCASE("converted output longer than the buffer is flushed in chunks") {
+    REQUIRE(npf_dprintf(1, "%40d", 42) == 40);
+    REQUIRE(s_fds[1].written == std::string(38, ' ') + "42");
+    REQUIRE(s_fds[1].writes == 3);
+  }
+
+  SUBCASE("output with more segments than fit is flushed in chunks") {
+    REQUIRE(npf_dprintf(1, "%s%s%s%s%s%s%s%s%s", "a", "b", "c", "d", "e", "f", "g",
+                        "h", "i") == 9);
+    REQUIRE(s_fds[1].written == "abcdefghi");
+    REQUIRE(s_fds[1].writes == 2);
+  }
+
+  SUBCASE("partial writes are resumed") {
+    s_fds[1].max_per_write = 3;
+    REQUIRE(npf_dprintf(1, "hello %s %d", "world", 1234) == 16);
+    REQUIRE(s_fds[1].written == "hello world 1234");
+    REQUIRE(s_fds[1].writes == 6);
+  }
+
+  SUBCASE("interrupted writes are retried") {
+    s_fds[1].eintr_count = 2;
+    REQUIRE(npf_dprintf(1, "abc") == 3);
+    REQUIRE(s_fds[1].written == "abc");
+  }
+
+  SUBCASE("write errors return -1 and stop formatting") {
+    int n = -1;
+    s_fds[1].fail_after_writes = 1;
+    REQUIRE(npf_dprintf(1, "%40d%n", 7, &n) == -1);
+    REQUIRE(s_fds[1].written == std::string(16, ' '));
+    REQUIRE(n == -1);
+  }
+}
@@ -0,0 +1,52 @@
+#define NANOPRINTF_USE_DURATION_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+TEST_CASE("duration") {
+  SUBCASE("parse") {
+    npf_format_spec_t spec;
+    REQUIRE(npf_parse_format_spec("%N", &spec) == 2);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_DURATION);
+    REQUIRE(npf_parse_format_spec("%lN", &spec) == 3);
+    REQUIRE(spec.length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG);
+  }
+
+  SUBCASE("largest unit, 3 significant digits") {
+    REQUIRE(fmt("%N", 0u) == "0ns");
+    REQUIRE(fmt("%N", 850u) == "850ns");
+    REQUIRE(fmt("%N", 1000u) == "1.00us");
+    REQUIRE(fmt("%N", 1234u) == "1.23us");
+    REQUIRE(fmt("%N", 12345678u) == "12.3ms");
+    REQUIRE(fmt("%N", 999500u) == "1.00ms");
+    REQUIRE(fmt("%N", 999999999u) == "1.00s");
+    REQUIRE(fmt("%N", 1500000000u) == "1.50s");
+  }
+
+  SUBCASE("seconds are the largest unit") {
+    REQUIRE(fmt("%N", 4000000000u) == "4.00s");
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    REQUIRE(fmt("%llN", 3600000000000ull) == "3600s");
+    REQUIRE(fmt("%llN", 3600499999999ull) == "3600s");
+    REQUIRE(fmt("%llN", 3600500000000ull) == "3601s");
+    REQUIRE(fmt("%.6llN", 3600250000000ull) == "3600.25s");
+    REQUIRE(fmt("%llN", ~0ull) == "18446744074s");
+#endif
+  }
+
+  SUBCASE("precision sets the significant digits") {
+    REQUIRE(fmt("%.5N", 1234567u) == "1.2346ms");
+    REQUIRE(fmt("%.1N", 1234567u) == "1ms");
+    REQUIRE(fmt("%.0N", 1500u) == "2us");
+    REQUIRE(fmt("%.6N", 123u) == "123ns");
+    REQUIRE(fmt("%.*N", 4, 2000001u) == "2.000ms");
+  }
+
+  SUBCASE("flags and field width") {
+    REQUIRE(fmt("%#N", 1234u) == "1.23 us");
+    REQUIRE(fmt("%8N|", 1234u) == "  1.23us|");
+    REQUIRE(fmt("%-8N|", 5u) == "5ns     |");
+    REQUIRE(fmt("%+N", 2000u) == "+2.00us");
+    REQUIRE(fmt("%hhN", 300u) == "44ns");
+  }
+}
@@ -0,0 +1,100 @@
+#define NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+TEST_CASE("fixed point") {
+  SUBCASE("parse") {
+    npf_format_spec_t spec;
+    REQUIRE(npf_parse_format_spec("%k", &spec) == 2);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_FIXED_POINT);
+    REQUIRE(npf_parse_format_spec("%hK", &spec) == 3);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_UFIXED_POINT);
+    REQUIRE(spec.length_modifier == NPF_FMT_SPEC_LEN_MOD_SHORT);
+  }
+
+  SUBCASE("every digit of the exact value by default") {
+    REQUIRE(fmt("%k", 15, 0x4000) == "0.5");
+    REQUIRE(fmt("%k", 15, 0x6000) == "0.75");
+    REQUIRE(fmt("%k", 15, 1) == "0.000030517578125");
+    REQUIRE(fmt("%k", 15, 0x7FFF) == "0.999969482421875");
+    REQUIRE(fmt("%k", 15, -0x8000) == "-1");
+    REQUIRE(fmt("%k", 15, 0) == "0");
+    REQUIRE(fmt("%k", 16, 0x18000) == "1.5");
+    REQUIRE(fmt("%k", 0, 42) == "42");
+    REQUIRE(fmt("%k", 4, -1) == "-0.0625");
+  }
+
+  SUBCASE("precision rounds like %f") {
+    REQUIRE(fmt("%.2k", 0, 42) == "42.00");
+    REQUIRE(fmt("%.3k", 16, 0x12000) == "1.125");
+    REQUIRE(fmt("%.2k", 16, 0x12000) == "1.13");
+    REQUIRE(fmt("%.3k", 28, 0x7FFFFFFF) == "8.000");
+    REQUIRE(fmt("%.0k", 1, 5) == "3");
+    REQUIRE(fmt("%#.0k", 1, 4) == "2.");
+    REQUIRE(fmt("%.20k", 2, 1) == "0.25000000000000000000");
+  }
+
+  SUBCASE("flags, field width and star arguments") {
+    REQUIRE(fmt("%+8.3k|", 8, 0x180) == "  +1.500|");
+    REQUIRE(fmt("% .1k", 8, 0x180) == " 1.5");
+    REQUIRE(fmt("%08.2k", 8, -0x180) == "-0001.50");
+    REQUIRE(fmt("%-8k|", 8, 0x180) == "1.5     |");
+    REQUIRE(fmt("%*.*k|", 10, 3, 4, -25) == "    -1.563|");
+    REQUIRE(fmt("%k|%d", 8, 0x280, 7) == "2.5|7");
+  }
+
+  SUBCASE("length modifiers and unsigned values") {
+    REQUIRE(fmt("%hk", 8, (short)-384) == "-1.5");
+    REQUIRE(fmt("%hhK", 4, (unsigned char)0xFF) == "15.9375");
+    REQUIRE(fmt("%K", 24, 0xFF800000u) == "255.5");
+    REQUIRE(fmt("%+K", 1, 3u) == "+1.5");
+    REQUIRE(fmt("%lk", 8, -256l) == "-1");
+  }
+
+  SUBCASE("Q30 and Q31 with few significant bits are exact") {
+    REQUIRE(fmt("%k", 31, 1) == "0.0000000004656612873077392578125");
+    REQUIRE(fmt("%k", 30, -1) == "-0.000000000931322574615478515625");
+    REQUIRE(fmt("%k", 31, 3) == "0.0000000013969838619232177734375");
+    REQUIRE(fmt("%.12k", 31, 1) == "0.000000000466");
+    REQUIRE(fmt("%.3k", 31, 0x40000000) == "0.500");
+  }
+
+  SUBCASE("fraction bits are clamped") {
+    REQUIRE(fmt("%k", -3, 7) == "7");
+    REQUIRE(fmt("%hhK", 1000, (unsigned char)0) == "0");
+  }
+
+#if defined(__GLIBC__)
+  SUBCASE("matches %f") {
+    // Exact while the fraction leaves 4 bits of NANOPRINTF_CONVERSION_FLOAT_TYPE.
+    std::mt19937 rng(7);
+    for (int i = 0; i < 20000; ++i) {
+      int const v = (int)rng() >> (rng() % 32);
+      int const q = (int)(rng() % (NPF_FTOA_MAN_BITS - 3));
+      char expected[256];
+      snprintf(expected, sizeof(expected), "%.*f", q, std::ldexp((double)v, -q));
+      CAPTURE(v);
+      CAPTURE(q);
+      REQUIRE(fmt("%.*k", q, q, v) == expected);
+    }
+  }
+#endif
+
+  SUBCASE("Q30 and Q31 match %f of the same value") {
+    std::mt19937 rng(11);
+    for (int i = 0; i < 20000; ++i) {
+      int const v = (int)rng() >> (rng() % 32);
+      int const q = 30 + (int)(rng() % 2);
+      int const prec = (int)(rng() % 40);
+      CAPTURE(v);
+      CAPTURE(q);
+      CAPTURE(prec);
+      REQUIRE(fmt("%.*k", prec, q, v) == fmt("%.*f", prec, std::ldexp((double)v, -q)));
+    }
+  }
+}
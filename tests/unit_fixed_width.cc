@@ -0,0 +1,123 @@
+#define NANOPRINTF_USE_FIXED_WIDTH_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <climits>
+#include <cstdint>
+#include <string>
+
+namespace {
+int len_mod(char const *format) {
+  npf_format_spec_t spec;
+  REQUIRE(npf_parse_format_spec(format, &spec));
+  return spec.length_modifier;
+}
+
+int exact_len_mod(size_t size) {
+  switch (size) {
+    case 1: return NPF_FMT_SPEC_LEN_MOD_W8;
+    case 2: return NPF_FMT_SPEC_LEN_MOD_W16;
+    case 4: return NPF_FMT_SPEC_LEN_MOD_W32;
+#if NPF_WIDE_UINT == 1
+    case 8: return NPF_FMT_SPEC_LEN_MOD_W64;
+#endif
+    default: break;
+  }
+  return NPF_FMT_SPEC_LEN_MOD_NONE;
+}
+}
+
+TEST_CASE("fixed width") {
+  SUBCASE("parses exact widths") {
+    REQUIRE(len_mod("%w8d") == NPF_FMT_SPEC_LEN_MOD_W8);
+    REQUIRE(len_mod("%w16u") == NPF_FMT_SPEC_LEN_MOD_W16);
+    REQUIRE(len_mod("%w32x") == NPF_FMT_SPEC_LEN_MOD_W32);
+#if NPF_WIDE_UINT == 1
+    REQUIRE(len_mod("%w64d") == NPF_FMT_SPEC_LEN_MOD_W64);
+#endif
+  }
+
+  SUBCASE("fast widths map onto the exact width of the same size") {
+    REQUIRE(len_mod("%wf8d") == exact_len_mod(sizeof(int_fast8_t)));
+    REQUIRE(len_mod("%wf16d") == exact_len_mod(sizeof(int_fast16_t)));
+    REQUIRE(len_mod("%wf32d") == exact_len_mod(sizeof(int_fast32_t)));
+#if NPF_WIDE_UINT == 1
+    REQUIRE(len_mod("%wf64d") == exact_len_mod(sizeof(int_fast64_t)));
+#endif
+  }
+
+  SUBCASE("unsupported widths are not conversions") {
+    npf_format_spec_t spec;
+    REQUIRE(!npf_parse_format_spec("%wd", &spec));
+    REQUIRE(!npf_parse_format_spec("%w7d", &spec));
+    REQUIRE(!npf_parse_format_spec("%wf12d", &spec));
+    REQUIRE(!npf_parse_format_spec("%w1024d", &spec));
+    REQUIRE(fmt("%w12d") == "%w12d");
+  }
+
+  SUBCASE("w8") {
+    REQUIRE(fmt("%w8d", (int8_t)-128) == "-128");
+    REQUIRE(fmt("%w8d", 300) == "44");
+    REQUIRE(fmt("%w8u", (uint8_t)255) == "255");
+    REQUIRE(fmt("%w8x", 0x1ff) == "ff");
+  }
+
+  SUBCASE("w16") {
+    REQUIRE(fmt("%w16d", (int16_t)INT16_MIN) == "-32768");
+    REQUIRE(fmt("%w16u", (uint16_t)UINT16_MAX) == "65535");
+    REQUIRE(fmt("%w16o", 0x1ffff) == "177777");
+  }
+
+  SUBCASE("w32") {
+    REQUIRE(fmt("%w32d", (int32_t)INT32_MIN) == "-2147483648");
+    REQUIRE(fmt("%w32i", (int32_t)INT32_MAX) == "2147483647");
+    REQUIRE(fmt("%w32u", (uint32_t)UINT32_MAX) == "4294967295");
+    REQUIRE(fmt("%w32X", (uint32_t)0xDEADBEEFu) == "DEADBEEF");
+    REQUIRE(fmt("%#w32o", (uint32_t)8) == "010");
+    REQUIRE(fmt("%+08w32d", (int32_t)-42) == "-0000042");
+    REQUIRE(fmt("%.5w32u", (uint32_t)7) == "00007");
+    REQUIRE(fmt("%.0w32u", (uint32_t)0) == "");
+  }
+
+#if NPF_WIDE_UINT == 1
+  SUBCASE("w64") {
+    REQUIRE(fmt("%w64d", (int64_t)INT64_MIN) == "-9223372036854775808");
+    REQUIRE(fmt("%w64u", (uint64_t)UINT64_MAX) == "18446744073709551615");
+    REQUIRE(fmt("%w64x", (uint64_t)0x123456789abcdefull) == "123456789abcdef");
+  }
+#endif
+
+  SUBCASE("fast widths") {
+    REQUIRE(fmt("%wf8d", (int_fast8_t)-7) == "-7");
+    REQUIRE(fmt("%wf16u", (uint_fast16_t)65535) == "65535");
+    REQUIRE(fmt("%wf32d", (int_fast32_t)INT32_MIN) == "-2147483648");
+#if NPF_WIDE_UINT == 1
+    REQUIRE(fmt("%wf64u", (uint_fast64_t)UINT64_MAX) == "18446744073709551615");
+#endif
+  }
+
+  SUBCASE("binary") {
+    REQUIRE(fmt("%w8b", 0x1ff) == "11111111");
+    REQUIRE(fmt("%w32b", (uint32_t)5) == "101");
+  }
+
+  SUBCASE("writeback") {
+    int8_t n8 = 0;
+    int16_t n16 = 0;
+    int32_t n32 = 0;
+    REQUIRE(fmt("abc%w8n", &n8) == "abc");
+    REQUIRE(n8 == 3);
+    REQUIRE(fmt("abcd%w16n", &n16) == "abcd");
+    REQUIRE(n16 == 4);
+    REQUIRE(fmt("abcde%w32n", &n32) == "abcde");
+    REQUIRE(n32 == 5);
+#if NPF_WIDE_UINT == 1
+    int64_t n64 = 0;
+    REQUIRE(fmt("ab%w64n", &n64) == "ab");
+    REQUIRE(n64 == 2);
+#endif
+  }
+
+  SUBCASE("arguments stay in sync") {
+    REQUIRE(fmt("%w8d %w16d %w32d %d", (int8_t)1, (int16_t)2, (int32_t)3, 4) == "1 2 3 4");
+  }
+}
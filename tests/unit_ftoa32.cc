@@ -0,0 +1,78 @@
+#define NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace {
+uint32_t bits_of(float f) {
+  uint32_t b;
+  memcpy(&b, &f, sizeof(b));
+  return b;
+}
+
+float float_of(uint32_t b) {
+  float f;
+  memcpy(&f, &b, sizeof(f));
+  return f;
+}
+
+
+std::string ftoa32(float f, int precision) {
+  char buf[256];
+  int const n = npf_ftoa32(buf, sizeof(buf), f, precision);
+  REQUIRE(n == (int)std::string(buf).size());
+  return buf;
+}
+}
+
+TEST_CASE("ftoa32") {
+  SUBCASE("%hf reads binary32 bits") {
+    REQUIRE(fmt("%hf", bits_of(1.5f)) == "1.500000");
+    REQUIRE(fmt("%.2hf", bits_of(-3.25f)) == "-3.25");
+    REQUIRE(fmt("%+.1hf", bits_of(2.f)) == "+2.0");
+    REQUIRE(fmt("%08.3hf", bits_of(-1.5f)) == "-001.500");
+    REQUIRE(fmt("%-8.1hf|", bits_of(9.75f)) == "9.8     |");
+    REQUIRE(fmt("%.0hf %d", bits_of(7.f), 42) == "7 42");
+  }
+
+  SUBCASE("special values") {
+    REQUIRE(fmt("%hf", bits_of(INFINITY)) == "inf");
+    REQUIRE(fmt("%hF", bits_of(-INFINITY)) == "-INF");
+    REQUIRE(fmt("%hf", bits_of(NAN)) == "nan");
+    REQUIRE(fmt("%hf", 0x80000000u) == "0.000000");
+    REQUIRE(fmt("%.1hf", 0xFF800001u) == "nan"); // negative nan has no sign, like doubles
+    REQUIRE(fmt("%hf", bits_of(FLT_MAX)) == fmt("%f", (double)FLT_MAX));
+  }
+
+  SUBCASE("matches the double path") {
+    char const *formats[] = { "%f", "%.0f", "%.3f", "%.9f", "%#.0f", "%.20f" };
+    char const *formats32[] = { "%hf", "%.0hf", "%.3hf", "%.9hf", "%#.0hf", "%.20hf" };
+    std::mt19937 rng(1234);
+    for (int i = 0; i < 100000; ++i) {
+      uint32_t const b = (uint32_t)rng();
+      int const f = i % 6;
+      CAPTURE(b);
+      REQUIRE(fmt(formats32[f], b) == fmt(formats[f], (double)float_of(b)));
+    }
+  }
+
+  SUBCASE("npf_ftoa32") {
+    REQUIRE(ftoa32(0.f, -1) == "0.000000");
+    REQUIRE(ftoa32(-12.5f, 1) == "-12.5");
+    REQUIRE(ftoa32(3.14159f, 3) == "3.142");
+    REQUIRE(ftoa32(-INFINITY, 2) == "-inf");
+    REQUIRE(ftoa32(1e10f, 0) == "10000000000");
+    REQUIRE(npf_ftoa32(nullptr, 0, -1.25f, 2) == 5);
+
+    char buf[4];
+    REQUIRE(npf_ftoa32(buf, sizeof(buf), -1.25f, 2) == 5);
+#ifdef NANOPRINTF_SNPRINTF_SAFE_EMPTY_STRING_ON_OVERFLOW
+    REQUIRE(std::string(buf).empty());
+#else
+    REQUIRE(std::string(buf) == "-1.");
+#endif
+  }
+}
@@ -0,0 +1,114 @@
+#define NANOPRINTF_USE_EXACT_FLOAT_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_FLOAT32_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_USE_FIXED_POINT_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+namespace {
+uint32_t bits_of(float f) {
+  uint32_t b;
+  memcpy(&b, &f, sizeof(b));
+  return b;
+}
+}
+
+TEST_CASE("ftoa_exact") {
+  SUBCASE("ties round to even") {
+    REQUIRE(fmt("%.0f", 0.5) == "0");
+    REQUIRE(fmt("%.0f", 1.5) == "2");
+    REQUIRE(fmt("%.0f", 2.5) == "2");
+    REQUIRE(fmt("%.1f", 0.25) == "0.2");
+    REQUIRE(fmt("%.1f", 0.75) == "0.8");
+    REQUIRE(fmt("%.2f", 1.125) == "1.12");
+    REQUIRE(fmt("%.2f", 1.375) == "1.38");
+    REQUIRE(fmt("%.3f", 2.0005) == "2.001"); // 2.0005 is slightly above the tie
+    REQUIRE(fmt("%.2f", 0.125 + 0x1p-52) == "0.13");
+  }
+
+  SUBCASE("rounding carries through 9s") {
+    REQUIRE(fmt("%.1f", 9.96) == "10.0");
+    REQUIRE(fmt("%.2f", 99.999) == "100.00");
+    REQUIRE(fmt("%.0f", 999999.5) == "1000000");
+    REQUIRE(fmt("%.3f", 0.9999) == "1.000");
+    REQUIRE(fmt("%.2f", 19.999) == "20.00");
+    REQUIRE(fmt("%.1f", 0.96) == "1.0");
+    REQUIRE(fmt("%8.2f|", 99.999) == "  100.00|");
+    REQUIRE(fmt("%08.1f", -9.96) == "-00010.0");
+  }
+
+  SUBCASE("every digit of the binary value") {
+    REQUIRE(fmt("%.20f", 0.1) == "0.10000000000000000555");
+    REQUIRE(fmt("%.55f", 0.1) == "0.1000000000000000055511151231257827021181583404541015625");
+    REQUIRE(fmt("%.60f", 2. / 3.) ==
+            "0.666666666666666629659232512494781985878944396972656250000000");
+    REQUIRE(fmt("%.0f", 1e23) == "99999999999999991611392");
+    REQUIRE(fmt("%.0f", 9007199254740993.) == "9007199254740992");
+    REQUIRE(fmt("%f", 1e300).substr(0, 40) == "1000000000000000052504760255204420248704");
+    REQUIRE(fmt("%.0f", DBL_MAX).size() == DBL_MAX_10_EXP + 1);
+    REQUIRE(fmt("%.0f", DBL_MAX).substr(300) == "124858368");
+    std::string const min = fmt("%.1074f", std::ldexp(1., -1074));
+    REQUIRE(min.size() == 1076);
+    REQUIRE(min.substr(0, 5) == "0.000");
+    REQUIRE(min.substr(1056) == "19718265533447265625");
+    REQUIRE(fmt("%.1100f", std::ldexp(1., -1074)).substr(1076) == std::string(26, '0'));
+  }
+
+  SUBCASE("signs and special values") {
+    REQUIRE(fmt("%f", -0.) == "-0.000000");
+    REQUIRE(fmt("%.0f", -0.4) == "-0");
+    REQUIRE(fmt("%+.1f", 0.) == "+0.0");
+    REQUIRE(fmt("% .1f", 1.) == " 1.0");
+    REQUIRE(fmt("%f", -(double)NAN) == "-nan");
+    REQUIRE(fmt("%F", (double)INFINITY) == "INF");
+    REQUIRE(fmt("%06f", -(double)INFINITY) == "  -inf");
+    REQUIRE(fmt("%-6f|", (double)NAN) == "nan   |");
+    REQUIRE(fmt("%#.0f", 3.) == "3.");
+  }
+
+  SUBCASE("%hf") {
+    REQUIRE(fmt("%.30hf", bits_of(0.1f)) == "0.100000001490116119384765625000");
+    REQUIRE(fmt("%.0hf", bits_of(FLT_MAX)) == "340282346638528859811704183484516925440");
+    REQUIRE(fmt("%hf", bits_of(-0.f)) == "-0.000000");
+    REQUIRE(npf_ftoa32(nullptr, 0, 2.5f, 0) == 1);
+  }
+
+  SUBCASE("fixed point") {
+    REQUIRE(fmt("%k", 31, 0x7FFFFFFF) == "0.9999999995343387126922607421875");
+    REQUIRE(fmt("%.2k", 16, 0x12000) == "1.12");
+    REQUIRE(fmt("%.0k", 1, 5) == "2");
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    REQUIRE(fmt("%llk", 64, -1ll) == "-0.0000000000000000000542101086242752217003726400434970855712890625");
+    REQUIRE(fmt("%llK", 0, ~0ull) == "18446744073709551615");
+    REQUIRE(fmt("%.1llK", 1, ~0ull) == "9223372036854775807.5");
+    REQUIRE(fmt("%llK", 32, ~0ull) == "4294967295.99999999976716935634613037109375");
+#endif
+  }
+
+#if defined(__GLIBC__)
+  SUBCASE("matches glibc") {
+    char const *formats[] = { "%f", "%.0f", "%.3f", "%.17f", "%#.0f", "%+.40f", "%.330f" };
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 50000; ++i) {
+      uint64_t const b = rng();
+      double d;
+      if (i % 2) {
+        memcpy(&d, &b, sizeof(d));
+      } else { // mostly values near the decimal point, plus exact ties
+        d = std::ldexp((double)(b >> 40), (int)(b % 64) - 40);
+      }
+      char const *f = formats[i % 7];
+      char expected[2048];
+      snprintf(expected, sizeof(expected), f, d);
+      CAPTURE(f);
+      CAPTURE(d);
+      REQUIRE(fmt(f, d) == expected);
+    }
+  }
+#endif
+}
@@ -0,0 +1,52 @@
+#include "unit_nanoprintf.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+
+std::string npf_ftoa_general(char const *format, double val); // unit_ftoa_fast_general.cc
+
+namespace {
+char const *const s_formats[] = {
+  "%.1f", "%.2f", "%.3f", "%.4f", "%.5f", "%.6f", "%.7f", "%.8f", "%.9f", "%#.2f" };
+}
+
+TEST_CASE("ftoa fast path") {
+  SUBCASE("common values") {
+    REQUIRE(fmt("%.2f", 0.001) == "0.00");
+    REQUIRE(fmt("%.2f", 0.125) == "0.13"); // ties round up
+    REQUIRE(fmt("%.4f", 3.14159265) == "3.1416");
+    REQUIRE(fmt("%.3f", 0.0625) == "0.063");
+    REQUIRE(fmt("%.2f", 999999999.999) == "1000000000.00");
+    REQUIRE(fmt("%.1f", 9.96) == "10.0");
+    REQUIRE(fmt("%.2f", -42.125) == "-42.13");
+    REQUIRE(fmt("%.9f", 0.5) == "0.500000000");
+    REQUIRE(fmt("%#.1f", 1e9) == "1000000000.0");
+  }
+
+  SUBCASE("matches the general path") {
+    std::mt19937_64 rng(20240611);
+    std::uniform_real_distribution<double> log_mag(-3., 9.);
+    for (int i = 0; i < (1 << 21); ++i) {
+      char const *format = s_formats[i % 10];
+      double val;
+      switch ((i / 10) % 4) {
+        case 0: val = std::pow(10., log_mag(rng)); break;
+        case 1: { // halfway cases, nudged by an ulp either way
+          double const scale = std::pow(10., (double)((i % 10) % 9 + 1));
+          val = (std::floor(std::pow(10., log_mag(rng)) * scale) + .5) / scale;
+          val = std::nextafter(val, ((i / 40) % 3 == 0) ? 0. : ((i / 40) % 3 == 1) ? 1e300 : val);
+        } break;
+        case 2: val = (double)(rng() % 100000000u) / 1000.; break;
+        default: { // any bit pattern
+          uint64_t const bits = rng();
+          memcpy(&val, &bits, sizeof(val));
+        } break;
+      }
+      CAPTURE(format);
+      CAPTURE(val);
+      REQUIRE(fmt(format, val) == npf_ftoa_general(format, val));
+    }
+  }
+}
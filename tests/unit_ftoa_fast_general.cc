@@ -0,0 +1,10 @@
+// Formats floats with the general digit loop only, as the reference for the
+// small-precision fast path tested in unit_ftoa_fast.cc.
+#define NPF_FTOA_FAST_PREC 0
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+std::string npf_ftoa_general(char const *format, double val);
+
+std::string npf_ftoa_general(char const *format, double val) { return fmt(format, val); }
@@ -27,12 +27,16 @@ static void memrev(char *lhs, char *rhs) {
 
 static void require_ftoa_rev(std::string const &expected, double dbl) {
   char buf[NANOPRINTF_CONVERSION_BUFFER_SIZE + 1];
-  int const n = npf_ftoa_rev(buf, &spec, dbl);
+  npf_ftoa_tail_t tail;
+  int const n = npf_ftoa_rev(buf, &spec, dbl, &tail);
   REQUIRE(n <= NANOPRINTF_CONVERSION_BUFFER_SIZE);
   memrev(buf, &buf[n]);
   buf[n] = '\0';
-  CHECK(std::string{buf} == std::string{expected});
-  CHECK(n == (int)expected.size());
+  std::string s{buf};
+  int const tail_len = npf_ftoa_tail_len(&tail);
+  for (int i = 0; i < tail_len; ++i) { s += npf_ftoa_tail_next(&tail); }
+  CHECK(s == expected);
+  CHECK(n + tail_len == (int)expected.size());
 }
 
 static void require_ftoa_rev_bin(char const *expected, npf_double_bin_t bin) {
@@ -49,13 +53,39 @@ TEST_CASE("ftoa_rev") {
     require_ftoa_rev("NAN", (double)-NAN);
     require_ftoa_rev("INF", (double)+INFINITY);
     require_ftoa_rev("INF", (double)-INFINITY);
-    require_ftoa_rev("ERR", DBL_MAX);
-    spec.prec = NANOPRINTF_CONVERSION_BUFFER_SIZE - 2;
-    require_ftoa_rev("ERR", 10.);
-    spec.prec += 1;
-    require_ftoa_rev("ERR", 9.);
     spec.case_adjust = 'a' - 'A'; // lowercase
-    require_ftoa_rev("err", 0.);
+    require_ftoa_rev("nan", (double)NAN);
+    require_ftoa_rev("inf", (double)INFINITY);
+  }
+
+  SUBCASE("digits beyond the conversion buffer") {
+    spec.prec = NANOPRINTF_CONVERSION_BUFFER_SIZE - 2;
+    require_ftoa_rev("10." + std::string((size_t)spec.prec, '0'), 10.);
+    spec.prec += 40;
+    require_ftoa_rev("9." + std::string((size_t)spec.prec, '0'), 9.);
+    spec.prec = 40;
+    require_ftoa_rev("0.0000000000000000000000000000000000000000", 1e-41);
+    require_ftoa_rev("0.0000000000000000000000000000000000000001", 1e-40);
+    spec.prec = 0;
+    char buf[NANOPRINTF_CONVERSION_BUFFER_SIZE + 1];
+    npf_ftoa_tail_t tail;
+    int n = npf_ftoa_rev(buf, &spec, 5e300, &tail);
+    REQUIRE(n <= NANOPRINTF_CONVERSION_BUFFER_SIZE);
+    REQUIRE(n + npf_ftoa_tail_len(&tail) == 301);
+    spec.prec = 1;
+    n = npf_ftoa_rev(buf, &spec, DBL_MAX, &tail);
+    REQUIRE(n <= NANOPRINTF_CONVERSION_BUFFER_SIZE);
+    REQUIRE(n + npf_ftoa_tail_len(&tail) == 311);
+  }
+
+  SUBCASE("rounding carries out of the streamed digits") {
+    spec.prec = 1;
+    require_ftoa_rev("10.0", 9.96);
+    spec.prec = 2;
+    require_ftoa_rev("0.01", 0.0096);
+    spec.prec = 0;
+    spec.alt_form = '#';
+    require_ftoa_rev("100.", 99.5);
   }
 
   SUBCASE("zero and decimal separator") {
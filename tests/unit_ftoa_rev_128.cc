@@ -0,0 +1,59 @@
+#if defined(__SIZEOF_INT128__)
+
+#define NANOPRINTF_CONVERSION_BUFFER_SIZE    512
+#define NANOPRINTF_CONVERSION_FLOAT_TYPE    unsigned __int128
+
+#include "unit_ftoa_rev.cc"
+
+TEST_CASE("ftoa_rev_128") {
+  memset(&spec, 0, sizeof(spec));
+
+  SUBCASE("layout") {
+    REQUIRE(NPF_FTOA_MAN_BITS == 128);
+    REQUIRE(NPF_FTOA_SHIFT_BITS == NPF_DOUBLE_MAN_BITS);
+  }
+
+  SUBCASE("integer overflow") {
+    spec.prec = 1;
+    require_ftoa_rev("2251799813685247.3", ((npf_double_bin_t)0x1 << (DBL_MANT_DIG - 2)) - 1 + 0.25);
+    require_ftoa_rev("2251799813685247.5", ((npf_double_bin_t)0x1 << (DBL_MANT_DIG - 2)) - 1 + 0.5);
+    require_ftoa_rev("2251799813685247.8", ((npf_double_bin_t)0x1 << (DBL_MANT_DIG - 2)) - 1 + 0.75);
+    require_ftoa_rev("4503599627370495.5", ((npf_double_bin_t)0x1 << (DBL_MANT_DIG - 1)) - 1 + 0.5);
+    require_ftoa_rev("9007199254740991.0", ((npf_double_bin_t)0x1 << DBL_MANT_DIG) - 1);
+    require_ftoa_rev("18446744073709549568.0", (npf_double_bin_t)-1 << (NPF_DOUBLE_BIN_BITS - DBL_MANT_DIG));
+    require_ftoa_rev("99999999999999997748809823456034029568.0", 1e38);
+    require_ftoa_rev("170141183460469231731687303715884105728.0", std::ldexp(1., 127));
+    require_ftoa_rev("340282366920938463463374607431768211460.0", std::ldexp(1., 128));
+  }
+
+  SUBCASE("fraction accuracy") {
+    spec.prec = 53 + 3;
+    require_ftoa_rev("1.00000000000000022204460492503130808472633361816406250000", 1. + 1. / ((npf_double_bin_t)0x1 << NPF_DOUBLE_MAN_BITS));
+    require_ftoa_rev("0.99999999999999988897769753748434595763683319091796875000", 1. - 1. / ((npf_double_bin_t)0x1 << DBL_MANT_DIG));
+    require_ftoa_rev("0.66666666666666662965923251249478198587894439697265625000", 2. / 3.);
+    require_ftoa_rev("0.00000000000000000000066666666666666663637148417385858114", 2. / 3. / 1e21);
+  }
+
+  SUBCASE("limits") {
+    // largest representable number, 39 significant digits
+    require_ftoa_rev_bin(
+      "17976931348623157081452742373170435658600000000000000000000000000000000000000000"
+      "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+      "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+      "000000000000000000000000000000000000000000000000000000000000000000000",
+      ((npf_double_bin_t)NPF_DOUBLE_EXP_MASK << NPF_DOUBLE_MAN_BITS) - 1);
+
+    spec.prec = 384 + 3;
+
+    // smallest representable number, exact to 34 significant digits
+    require_ftoa_rev_bin(
+      "0.000000000000000000000000000000000000000000000000000000000000000000000000000000"
+      "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+      "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+      "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+      "000004940656458412465441765687928682213720705133458640517111225829497",
+      (npf_double_bin_t)0x1 << 0);
+  }
+}
+
+#endif
@@ -0,0 +1,104 @@
+#define NANOPRINTF_CONVERSION_BUFFER_SIZE    512
+#define NANOPRINTF_CONVERSION_FLOAT_TYPE    uint64_t
+#define NANOPRINTF_USE_LONG_DOUBLE_FORMAT_SPECIFIERS 1
+
+#include "unit_nanoprintf.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wunused-function"
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+    #pragma GCC diagnostic ignored "-Wmissing-prototypes"
+    #pragma GCC diagnostic ignored "-Wold-style-cast"
+  #endif
+#endif
+
+static npf_format_spec_t spec;
+
+static void require_ftoa_rev(std::string const &expected, long double ld) {
+  char buf[NANOPRINTF_CONVERSION_BUFFER_SIZE + 1];
+  npf_ftoa_tail_t tail;
+  int const n = npf_ftoa_rev(buf, &spec, ld, &tail);
+  REQUIRE(n <= NANOPRINTF_CONVERSION_BUFFER_SIZE);
+  std::string const rev(buf, (size_t)n);
+  std::string s(rev.rbegin(), rev.rend());
+  for (int i = npf_ftoa_tail_len(&tail); i > 0; --i) { s += npf_ftoa_tail_next(&tail); }
+  CHECK(s == expected);
+}
+
+template <class T> static std::string fmt(char const *format, T val) {
+  char buf[128];
+  npf_snprintf(buf, sizeof(buf), format, val);
+  return buf;
+}
+
+TEST_CASE("ftoa_rev_long_double") {
+  memset(&spec, 0, sizeof(spec));
+
+  SUBCASE("layout") {
+    REQUIRE(NPF_DOUBLE_MAN_BITS == LDBL_MANT_DIG - 1);
+    REQUIRE(NPF_DOUBLE_EXP_BIAS == LDBL_MAX_EXP - 1);
+  }
+
+  SUBCASE("special values") {
+    require_ftoa_rev("NAN", (long double)NAN);
+    require_ftoa_rev("INF", (long double)INFINITY);
+    require_ftoa_rev("INF", -(long double)INFINITY);
+    char buf[NANOPRINTF_CONVERSION_BUFFER_SIZE + 1];
+    npf_ftoa_tail_t tail;
+    int const n = npf_ftoa_rev(buf, &spec, LDBL_MAX, &tail);
+    REQUIRE(n <= NANOPRINTF_CONVERSION_BUFFER_SIZE);
+    REQUIRE(n + npf_ftoa_tail_len(&tail) == LDBL_MAX_10_EXP + 1);
+    spec.case_adjust = 'a' - 'A'; // lowercase
+    require_ftoa_rev("nan", (long double)NAN);
+  }
+
+  SUBCASE("doubles are widened exactly") {
+    spec.prec = 3;
+    require_ftoa_rev("0.100", 0.1);
+    require_ftoa_rev("2.500", 2.5);
+    spec.prec = 1;
+    require_ftoa_rev("9007199254740991.0", 9007199254740991.);
+  }
+
+#if LDBL_MANT_DIG >= 64
+  SUBCASE("integers wider than double") {
+    spec.prec = 1;
+    require_ftoa_rev("18446744073709551615.0", 18446744073709551615.0L);
+    require_ftoa_rev("9223372036854775807.5", 9223372036854775807.5L);
+    require_ftoa_rev("12345678901234567890.0", 12345678901234567890.0L);
+    spec.prec = 0;
+    require_ftoa_rev("100000000000000000000", 1e20L);
+  }
+
+  SUBCASE("fraction accuracy") {
+    spec.prec = 62;
+    require_ftoa_rev("1.00000000000000000086736173798840354720596224069595336914062500",
+                     1.0L + std::ldexp(1.0L, -60));
+    require_ftoa_rev("0.50000000000000000346944695195361418882384896278381347656250000",
+                     0.5L + std::ldexp(1.0L, -58));
+    spec.prec = 70;
+    require_ftoa_rev(
+      "0.0000000000000000002168404344971008868014905601739883422851562500000000",
+      std::ldexp(1.0L, -62));
+    require_ftoa_rev(
+      "0.9999999999999999991326382620115964527940377593040466308593750000000000",
+      1.0L - std::ldexp(1.0L, -60));
+  }
+
+  SUBCASE("%L is not cast to double") {
+    REQUIRE(fmt("%.1Lf", 18446744073709551615.0L) == "18446744073709551615.0");
+    REQUIRE(fmt("%.20Lf", 1.0L + std::ldexp(1.0L, -60)) == "1.00000000000000000087");
+    REQUIRE(fmt("%.20f", (double)(1.0L + std::ldexp(1.0L, -60))) == "1.00000000000000000000");
+  }
+#endif
+}
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic pop
+#endif
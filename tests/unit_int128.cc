@@ -0,0 +1,86 @@
+#if defined(__SIZEOF_INT128__) && (NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1)
+  #define NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS 1
+#endif
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+#if NANOPRINTF_USE_INT128_FORMAT_SPECIFIERS == 1
+
+namespace {
+__extension__ typedef __int128 i128;
+__extension__ typedef unsigned __int128 u128;
+
+u128 const kU128Max = ~(u128)0;
+i128 const kI128Max = (i128)(kU128Max >> 1);
+i128 const kI128Min = -kI128Max - 1;
+u128 const k1e19 = (u128)10000000000000000000ull;
+
+}
+
+TEST_CASE("int128") {
+  SUBCASE("parses w128 as a length modifier") {
+    npf_format_spec_t spec;
+    REQUIRE(npf_parse_format_spec("%w128d", &spec) == 6);
+    REQUIRE(spec.length_modifier == NPF_FMT_SPEC_LEN_MOD_LARGE_INT128);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_SIGNED_INT);
+  }
+
+  SUBCASE("incomplete w modifiers are not conversions") {
+    npf_format_spec_t spec;
+    REQUIRE(!npf_parse_format_spec("%wd", &spec));
+    REQUIRE(!npf_parse_format_spec("%w12d", &spec));
+    REQUIRE(fmt("%w12d") == "%w12d");
+  }
+
+  SUBCASE("signed decimal") {
+    REQUIRE(fmt("%w128d", (i128)0) == "0");
+    REQUIRE(fmt("%w128d", (i128)-1) == "-1");
+    REQUIRE(fmt("%w128i", kI128Max) == "170141183460469231731687303715884105727");
+    REQUIRE(fmt("%w128d", kI128Min) == "-170141183460469231731687303715884105728");
+  }
+
+  SUBCASE("unsigned decimal") {
+    REQUIRE(fmt("%w128u", kU128Max) == "340282366920938463463374607431768211455");
+    REQUIRE(fmt("%w128u", (u128)1 << 64) == "18446744073709551616");
+    REQUIRE(fmt("%w128u", k1e19) == "10000000000000000000");
+    REQUIRE(fmt("%w128u", k1e19 * k1e19) == "100000000000000000000000000000000000000");
+    REQUIRE(fmt("%w128u", k1e19 * k1e19 - 1) == std::string(38, '9'));
+  }
+
+  SUBCASE("chunk boundaries keep inner zeros") {
+    REQUIRE(fmt("%w128u", k1e19 * 5 + 7) == "50000000000000000007");
+    REQUIRE(fmt("%w128u", (k1e19 * k1e19) + 1) ==
+            "100000000000000000000000000000000000001");
+  }
+
+  SUBCASE("hex and octal") {
+    REQUIRE(fmt("%w128x", kU128Max) == std::string(32, 'f'));
+    REQUIRE(fmt("%#w128X", (u128)0xABCD << 100) == "0XABCD0000000000000000000000000");
+    REQUIRE(fmt("%w128o", kU128Max) == "3" + std::string(42, '7'));
+    REQUIRE(fmt("%#w128o", kU128Max) == "03" + std::string(42, '7'));
+  }
+
+  SUBCASE("binary") {
+    REQUIRE(fmt("%w128b", kU128Max) == std::string(128, '1'));
+    REQUIRE(fmt("%w128b", (u128)1 << 64) == "1" + std::string(64, '0'));
+    REQUIRE(fmt("%w128b", (u128)5) == "101");
+  }
+
+  SUBCASE("field width and precision") {
+    REQUIRE(fmt("%45w128u", kU128Max) == "      340282366920938463463374607431768211455");
+    REQUIRE(fmt("%.40w128d", (i128)-5) == "-" + std::string(39, '0') + "5");
+  }
+
+  SUBCASE("mixes with other arguments") {
+    REQUIRE(fmt("%d %w128u %d", 1, (u128)1 << 64, 2) == "1 18446744073709551616 2");
+  }
+
+  SUBCASE("writeback") {
+    i128 n = -1;
+    REQUIRE(fmt("abcd%w128n", &n) == "abcd");
+    REQUIRE(n == 4);
+  }
+}
+
+#endif
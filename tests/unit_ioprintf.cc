@@ -0,0 +1,90 @@
+#define NANOPRINTF_IOVEC
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+  #endif
+  #pragma GCC diagnostic ignored "-Wformat-zero-length"
+#endif
+
+namespace {
+std::string seg(npf_iovec_t const &v) {
+  return std::string(static_cast<char const *>(v.iov_base), v.iov_len);
+}
+
+std::string join(npf_iovec_t const *iov, int n) {
+  std::string s;
+  for (int i = 0; i < n; ++i) { s += seg(iov[i]); }
+  return s;
+}
+}
+
+TEST_CASE("npf_ioprintf") {
+  npf_iovec_t iov[8];
+  char scratch[16];
+  int cnt = 8;
+
+  SUBCASE("empty string has no segments") {
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch), "") == 0);
+    REQUIRE(cnt == 0);
+  }
+
+  SUBCASE("literal text points into the format string") {
+    char const *fmt = "hello world";
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch), fmt) == 11);
+    REQUIRE(cnt == 1);
+    REQUIRE(iov[0].iov_base == fmt);
+    REQUIRE(iov[0].iov_len == 11);
+  }
+
+  SUBCASE("string arguments are not copied") {
+    char const *body = "a long request body";
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch), "[%s]", body) == 21);
+    REQUIRE(cnt == 3);
+    REQUIRE(iov[1].iov_base == body);
+    REQUIRE(seg(iov[1]) == body);
+    REQUIRE(join(iov, cnt) == "[a long request body]");
+  }
+
+  SUBCASE("precision limits the string segment") {
+    char const *body = "abcdef";
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch), "%.3s", body) == 3);
+    REQUIRE(cnt == 1);
+    REQUIRE(iov[0].iov_base == body);
+    REQUIRE(iov[0].iov_len == 3);
+  }
+
+  SUBCASE("converted bytes share one scratch segment") {
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch), "%d%x%c", -12, 255, '!') == 6);
+    REQUIRE(cnt == 1);
+    REQUIRE(iov[0].iov_base == scratch);
+    REQUIRE(seg(iov[0]) == "-12ff!");
+  }
+
+  SUBCASE("padding lands in scratch around the string segment") {
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch), "%4s|%-3s|", "ab", "c") == 9);
+    REQUIRE(join(iov, cnt) == "  ab|c  |");
+  }
+
+  SUBCASE("mixed output") {
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch),
+                         "GET %s HTTP/1.%d\r\n", "/index.html", 1) == 26);
+    REQUIRE(cnt == 5);
+    REQUIRE(join(iov, cnt) == "GET /index.html HTTP/1.1\r\n");
+  }
+
+  SUBCASE("running out of segments returns -1") {
+    cnt = 2;
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, sizeof(scratch), "a%sb%sc", "x", "y") == -1);
+    REQUIRE(cnt == 2);
+    REQUIRE(join(iov, cnt) == "ax");
+  }
+
+  SUBCASE("running out of scratch returns -1") {
+    REQUIRE(npf_ioprintf(iov, &cnt, scratch, 2, "%d", 12345) == -1);
+  }
+}
@@ -18,6 +18,8 @@
 
 #include "../nanoprintf.h"
 
+#include <string>
+
 #if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
   #pragma GCC diagnostic push
   #if NANOPRINTF_CLANG
@@ -41,3 +43,22 @@
 #endif
 
 #include "doctest.h"
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#endif
+
+namespace {
+// Formats into a std::string, and checks that the return value matches its length.
+template <class... Args> std::string fmt(char const *format, Args... args) {
+  char buf[2048];
+  int const n = npf_snprintf(buf, sizeof(buf), format, args...);
+  REQUIRE(n == (int)std::string(buf).size());
+  return buf;
+}
+}
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,107 @@
+namespace {
+unsigned long long s_ticks;
+unsigned long long test_clock() { return s_ticks += 10; }
+}
+
+#define NANOPRINTF_PROFILE
+#define NANOPRINTF_PROFILE_CLOCK() test_clock()
+#include "unit_nanoprintf.h"
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+  #endif
+#endif
+
+namespace {
+npf_profile_counters_t profile(npf_profile_conv_t conv) {
+  npf_profile_t p;
+  npf_profile_snapshot(&p);
+  return p.conv[conv];
+}
+}
+
+TEST_CASE("npf_profile") {
+  char buf[64];
+  npf_profile_reset();
+
+  SUBCASE("reset clears every counter") {
+    npf_snprintf(buf, sizeof(buf), "%d %s %x", 1, "a", 2u);
+    npf_profile_reset();
+    npf_profile_t p;
+    npf_profile_snapshot(&p);
+    for (int i = 0; i < NPF_PROFILE_CONV_COUNT; ++i) {
+      REQUIRE(p.conv[i].count == 0);
+      REQUIRE(p.conv[i].bytes == 0);
+      REQUIRE(p.conv[i].pad_bytes == 0);
+      REQUIRE(p.conv[i].cycles == 0);
+    }
+  }
+
+  SUBCASE("literal text isn't counted") {
+    npf_snprintf(buf, sizeof(buf), "hello");
+    npf_profile_t p;
+    npf_profile_snapshot(&p);
+    for (int i = 0; i < NPF_PROFILE_CONV_COUNT; ++i) { REQUIRE(p.conv[i].count == 0); }
+  }
+
+  SUBCASE("counts and bytes accumulate per conversion") {
+    npf_snprintf(buf, sizeof(buf), "%d,%d,%u", 12, -345, 6u);
+    REQUIRE(profile(NPF_PROFILE_CONV_SIGNED_INT).count == 2);
+    REQUIRE(profile(NPF_PROFILE_CONV_SIGNED_INT).bytes == 6);
+    REQUIRE(profile(NPF_PROFILE_CONV_UNSIGNED_INT).count == 1);
+    REQUIRE(profile(NPF_PROFILE_CONV_UNSIGNED_INT).bytes == 1);
+    REQUIRE(profile(NPF_PROFILE_CONV_HEX_INT).count == 0);
+  }
+
+  SUBCASE("field width padding") {
+    npf_snprintf(buf, sizeof(buf), "%5d|%-4s|%03x", 42, "ab", 7u);
+    REQUIRE(profile(NPF_PROFILE_CONV_SIGNED_INT).bytes == 5);
+    REQUIRE(profile(NPF_PROFILE_CONV_SIGNED_INT).pad_bytes == 3);
+    REQUIRE(profile(NPF_PROFILE_CONV_STRING).bytes == 4);
+    REQUIRE(profile(NPF_PROFILE_CONV_STRING).pad_bytes == 2);
+    REQUIRE(profile(NPF_PROFILE_CONV_HEX_INT).bytes == 3);
+    REQUIRE(profile(NPF_PROFILE_CONV_HEX_INT).pad_bytes == 2);
+  }
+
+  SUBCASE("precision padding") {
+    npf_snprintf(buf, sizeof(buf), "%.4d", 7);
+    REQUIRE(profile(NPF_PROFILE_CONV_SIGNED_INT).bytes == 4);
+    REQUIRE(profile(NPF_PROFILE_CONV_SIGNED_INT).pad_bytes == 3);
+  }
+
+  SUBCASE("float and pointer conversions") {
+    npf_snprintf(buf, sizeof(buf), "%f %p %%", 1.5, (void *)buf);
+    REQUIRE(profile(NPF_PROFILE_CONV_FLOAT_DEC).count == 1);
+    REQUIRE(profile(NPF_PROFILE_CONV_FLOAT_DEC).bytes == 8);
+    REQUIRE(profile(NPF_PROFILE_CONV_POINTER).count == 1);
+    REQUIRE(profile(NPF_PROFILE_CONV_PERCENT).count == 1);
+    REQUIRE(profile(NPF_PROFILE_CONV_PERCENT).bytes == 1);
+  }
+
+  SUBCASE("counts the bytes of npf_snprintf(NULL, 0, ...) too") {
+    REQUIRE(npf_snprintf(nullptr, 0, "%10s", "x") == 10);
+    REQUIRE(profile(NPF_PROFILE_CONV_STRING).bytes == 10);
+    REQUIRE(profile(NPF_PROFILE_CONV_STRING).pad_bytes == 9);
+  }
+
+  SUBCASE("cycles come from the clock hook") {
+    npf_snprintf(buf, sizeof(buf), "%c%c", 'a', 'b');
+    REQUIRE(profile(NPF_PROFILE_CONV_CHAR).count == 2);
+    REQUIRE(profile(NPF_PROFILE_CONV_CHAR).cycles == 20);
+  }
+
+  SUBCASE("snapshot is a copy") {
+    npf_profile_t p;
+    npf_snprintf(buf, sizeof(buf), "%d", 1);
+    npf_profile_snapshot(&p);
+    npf_snprintf(buf, sizeof(buf), "%d", 1);
+    REQUIRE(p.conv[NPF_PROFILE_CONV_SIGNED_INT].count == 1);
+    REQUIRE(profile(NPF_PROFILE_CONV_SIGNED_INT).count == 2);
+  }
+}
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,61 @@
+#define NANOPRINTF_USE_SCALED_DECIMAL_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <climits>
+#include <string>
+
+TEST_CASE("scaled decimal") {
+  SUBCASE("parse") {
+    npf_format_spec_t spec;
+    REQUIRE(npf_parse_format_spec("%D", &spec) == 2);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_SCALED_DEC);
+    REQUIRE(npf_parse_format_spec("%lU", &spec) == 3);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_USCALED_DEC);
+    REQUIRE(spec.length_modifier == NPF_FMT_SPEC_LEN_MOD_LONG);
+  }
+
+  SUBCASE("the scale places the decimal point") {
+    REQUIRE(fmt("%D", 3, 12345) == "12.345");
+    REQUIRE(fmt("%D", 3, 12000) == "12.000");
+    REQUIRE(fmt("%D", 3, -5) == "-0.005");
+    REQUIRE(fmt("%D", 2, 0) == "0.00");
+    REQUIRE(fmt("%D", 0, 7) == "7");
+    REQUIRE(fmt("%D", -3, 12) == "12000");
+    REQUIRE(fmt("%U", 2, UINT_MAX) == "42949672.95");
+    REQUIRE(fmt("%D|%d", 1, 15, 3) == "1.5|3");
+  }
+
+  SUBCASE("precision rounds half away from zero or pads") {
+    REQUIRE(fmt("%.1D", 3, 12345) == "12.3");
+    REQUIRE(fmt("%.1D", 3, 12355) == "12.4");
+    REQUIRE(fmt("%.1D", 3, -12355) == "-12.4");
+    REQUIRE(fmt("%.0D", 3, -999) == "-1");
+    REQUIRE(fmt("%.2D", 30, 5) == "0.00");
+    REQUIRE(fmt("%.5D", 2, 150) == "1.50000");
+    REQUIRE(fmt("%.*D", 1, 2, 995) == "10.0");
+    REQUIRE(fmt("%#.0D", 2, 150) == "2.");
+  }
+
+  SUBCASE("flags and field width") {
+    REQUIRE(fmt("%+10.2D|", 3, 1234) == "     +1.23|");
+    REQUIRE(fmt("% D", 1, 5) == " 0.5");
+    REQUIRE(fmt("%-8D|", 2, 5) == "0.05    |");
+    REQUIRE(fmt("%08D", 2, -150) == "-0001.50");
+    REQUIRE(fmt("%+U", 1, 5u) == "+0.5");
+  }
+
+  SUBCASE("length modifiers") {
+    REQUIRE(fmt("%hhD", 1, (signed char)-128) == "-12.8");
+    REQUIRE(fmt("%hU", 4, (unsigned short)65535) == "6.5535");
+    REQUIRE(fmt("%lD", 3, -1234567l) == "-1234.567");
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    REQUIRE(fmt("%llD", 3, LLONG_MIN) == "-9223372036854775.808");
+    REQUIRE(fmt("%llU", 19, ULLONG_MAX) == "1.8446744073709551615");
+#endif
+  }
+
+  SUBCASE("too long for the conversion buffer") {
+    REQUIRE(fmt("%.30D", 2, 1) == "err");
+    REQUIRE(fmt("%D", -30, 1) == "err");
+  }
+}
@@ -0,0 +1,65 @@
+#define NANOPRINTF_USE_UNIT_PREFIX_FORMAT_SPECIFIERS 1
+#include "unit_nanoprintf.h"
+
+#include <climits>
+#include <string>
+
+TEST_CASE("unit prefixes") {
+  SUBCASE("parse") {
+    npf_format_spec_t spec;
+    REQUIRE(npf_parse_format_spec("%M", &spec) == 2);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_SI_PREFIX);
+    REQUIRE(npf_parse_format_spec("%lI", &spec) == 3);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_IEC_PREFIX);
+  }
+
+  SUBCASE("SI prefixes, 3 significant digits") {
+    REQUIRE(fmt("%M", 0u) == "0");
+    REQUIRE(fmt("%M", 999u) == "999");
+    REQUIRE(fmt("%M", 1000u) == "1.00k");
+    REQUIRE(fmt("%M", 1234u) == "1.23k");
+    REQUIRE(fmt("%M", 12345u) == "12.3k");
+    REQUIRE(fmt("%M", 123456u) == "123k");
+    REQUIRE(fmt("%M", 1235000u) == "1.24M");
+    REQUIRE(fmt("%M", 999499u) == "999k");
+    REQUIRE(fmt("%M", 999500u) == "1.00M");
+    REQUIRE(fmt("%M", 4000000000u) == "4.00G");
+  }
+
+  SUBCASE("IEC prefixes, 3 significant digits") {
+    REQUIRE(fmt("%I", 1023u) == "1023");
+    REQUIRE(fmt("%I", 1024u) == "1.00Ki");
+    REQUIRE(fmt("%I", 1536u) == "1.50Ki");
+    REQUIRE(fmt("%I", 1048063u) == "1023Ki");
+    REQUIRE(fmt("%I", 1048064u) == "1.00Mi");
+    REQUIRE(fmt("%IB", 3u << 30) == "3.00GiB");
+  }
+
+  SUBCASE("precision sets the significant digits") {
+    REQUIRE(fmt("%.5M", 1234567u) == "1.2346M");
+    REQUIRE(fmt("%.1M", 1234567u) == "1M");
+    REQUIRE(fmt("%.0M", 1500u) == "2k");
+    REQUIRE(fmt("%.1I", 1048063u) == "1023Ki");
+    REQUIRE(fmt("%.4I", 1000u) == "1000");
+  }
+
+  SUBCASE("flags and field width") {
+    REQUIRE(fmt("%#MB", 512u) == "512 B");
+    REQUIRE(fmt("%#IB", 1536u) == "1.50 KiB");
+    REQUIRE(fmt("%8.2M|", 1230000u) == "    1.2M|");
+    REQUIRE(fmt("%-8M|", 1230000u) == "1.23M   |");
+    REQUIRE(fmt("%+M", 5u) == "+5");
+    REQUIRE(fmt("%07.2M", 1230000u) == "0001.2M");
+  }
+
+  SUBCASE("length modifiers") {
+    REQUIRE(fmt("%hhM", (unsigned char)200) == "200");
+    REQUIRE(fmt("%hI", (unsigned short)65535) == "64.0Ki");
+#if NANOPRINTF_USE_LARGE_FORMAT_SPECIFIERS == 1
+    REQUIRE(fmt("%llM", ULLONG_MAX) == "18.4E");
+    REQUIRE(fmt("%llI", ULLONG_MAX) == "16.0Ei");
+    REQUIRE(fmt("%.12llM", 123456789012345ull) == "123.456789012T");
+    REQUIRE(fmt("%#llIB", 4831838208ull) == "4.50 GiB");
+#endif
+  }
+}
@@ -0,0 +1,75 @@
+#define NANOPRINTF_SNPRINTF_TRUNC
+#include "unit_nanoprintf.h"
+
+#include <string>
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+  #endif
+  #pragma GCC diagnostic ignored "-Wformat-zero-length"
+#endif
+
+TEST_CASE("npf_snprintf_trunc") {
+  char buf[9];
+  buf[0] = '@';
+  buf[7] = '*';
+  buf[8] = '!';
+  int trunc = -1;
+
+  SUBCASE("zero-sized buffer") {
+    REQUIRE(npf_snprintf_trunc(buf, 0, &trunc, "abc") == 0);
+    REQUIRE(trunc == 1);
+    REQUIRE(buf[0] == '@');
+  }
+
+  SUBCASE("zero-sized buffer and empty output is not truncated") {
+    REQUIRE(npf_snprintf_trunc(buf, 0, &trunc, "") == 0);
+    REQUIRE(trunc == 0);
+  }
+
+  SUBCASE("null buffer writes nothing") {
+    REQUIRE(npf_snprintf_trunc(nullptr, 8, &trunc, "abc") == 0);
+    REQUIRE(trunc == 1);
+  }
+
+  SUBCASE("small string") {
+    REQUIRE(npf_snprintf_trunc(buf, 8, &trunc, "a%dc", 2) == 3);
+    REQUIRE(trunc == 0);
+    REQUIRE(std::string{buf} == "a2c");
+  }
+
+  SUBCASE("exact fit string") {
+    REQUIRE(npf_snprintf_trunc(buf, 8, &trunc, "%s", "1234567") == 7);
+    REQUIRE(trunc == 0);
+    REQUIRE(std::string{buf} == "1234567");
+  }
+
+  SUBCASE("if the null terminator doesn't fit, the string is trimmed") {
+    REQUIRE(npf_snprintf_trunc(buf, 8, &trunc, "12345678") == 7);
+    REQUIRE(trunc == 1);
+    REQUIRE(std::string{buf} == "1234567");
+    REQUIRE(buf[8] == '!');
+  }
+
+  SUBCASE("truncated flag is optional") {
+    REQUIRE(npf_snprintf_trunc(buf, 4, nullptr, "%d", 123456) == 3);
+    REQUIRE(std::string{buf} == "123");
+  }
+
+  SUBCASE("conversions after the buffer fills are skipped") {
+    int n = -1;
+    REQUIRE(npf_snprintf_trunc(buf, 4, &trunc, "%s%n%d", "abcdef", &n, 5) == 3);
+    REQUIRE(trunc == 1);
+    REQUIRE(n == -1);
+    REQUIRE(std::string{buf} == "abc");
+  }
+
+  SUBCASE("conversions before the buffer fills still run") {
+    int n = -1;
+    REQUIRE(npf_snprintf_trunc(buf, 8, &trunc, "ab%ncdefghij", &n) == 7);
+    REQUIRE(trunc == 1);
+    REQUIRE(n == 2);
+  }
+}
@@ -0,0 +1,125 @@
+#define NANOPRINTF_USE_TIMESTAMP_FORMAT_SPECIFIERS 1
+#define NANOPRINTF_IOVEC
+#include "unit_nanoprintf.h"
+
+#include <climits>
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <string>
+
+namespace {
+npf_timestamp_t at(long long sec, long nsec = 0) {
+  npf_timestamp_t ts = {};
+  ts.sec = sec;
+  ts.nsec = nsec;
+  return ts;
+}
+}
+
+TEST_CASE("timestamp") {
+  SUBCASE("parse") {
+    npf_format_spec_t spec;
+    REQUIRE(npf_parse_format_spec("%T", &spec) == 2);
+    REQUIRE(spec.conv_spec == NPF_FMT_SPEC_CONV_TIMESTAMP);
+    REQUIRE(npf_parse_format_spec("%0.3T", &spec) == 5);
+    REQUIRE(spec.leading_zero_pad == 0);
+  }
+
+  SUBCASE("dates") {
+    npf_timestamp_t ts = at(0);
+    REQUIRE(fmt("%T", &ts) == "1970-01-01T00:00:00Z");
+    ts = at(1715934615);
+    REQUIRE(fmt("%T", &ts) == "2024-05-17T08:30:15Z");
+    ts = at(951782400); // leap day
+    REQUIRE(fmt("%T", &ts) == "2000-02-29T00:00:00Z");
+    ts = at(4107542399);
+    REQUIRE(fmt("%T", &ts) == "2100-02-28T23:59:59Z");
+    ts = at(253402300799);
+    REQUIRE(fmt("%T", &ts) == "9999-12-31T23:59:59Z");
+    ts = at(253402300800);
+    REQUIRE(fmt("%T", &ts) == "10000-01-01T00:00:00Z");
+  }
+
+  SUBCASE("before 1970") {
+    npf_timestamp_t ts = at(-1);
+    REQUIRE(fmt("%T", &ts) == "1969-12-31T23:59:59Z");
+    ts = at(-62167219200);
+    REQUIRE(fmt("%T", &ts) == "0000-01-01T00:00:00Z");
+    ts = at(-62167219201);
+    REQUIRE(fmt("%T", &ts) == "-0001-12-31T23:59:59Z");
+    ts = at(LLONG_MIN);
+    REQUIRE(fmt("%T", &ts) == "-292277022657-01-27T08:29:52Z");
+    ts = at(LLONG_MAX);
+    REQUIRE(fmt("%T", &ts) == "292277026596-12-04T15:30:07Z");
+  }
+
+  SUBCASE("precision is truncated fraction digits") {
+    npf_timestamp_t ts = at(1715934615, 250999999);
+    REQUIRE(fmt("%.3T", &ts) == "2024-05-17T08:30:15.250Z");
+    REQUIRE(fmt("%.1T", &ts) == "2024-05-17T08:30:15.2Z");
+    REQUIRE(fmt("%.9T", &ts) == "2024-05-17T08:30:15.250999999Z");
+    REQUIRE(fmt("%.12T", &ts) == "2024-05-17T08:30:15.250999999Z");
+    REQUIRE(fmt("%.0T", &ts) == "2024-05-17T08:30:15Z");
+    ts.nsec = 5;
+    REQUIRE(fmt("%.9T", &ts) == "2024-05-17T08:30:15.000000005Z");
+  }
+
+  SUBCASE("field width") {
+    npf_timestamp_t ts = at(0);
+    REQUIRE(fmt("[%22T]", &ts) == "[  1970-01-01T00:00:00Z]");
+    REQUIRE(fmt("[%-22T]", &ts) == "[1970-01-01T00:00:00Z  ]");
+    REQUIRE(fmt("[%022T]", &ts) == "[  1970-01-01T00:00:00Z]");
+    REQUIRE(fmt("%T %d", &ts, 7) == "1970-01-01T00:00:00Z 7");
+  }
+
+  SUBCASE("the date, hour and minute are cached") {
+    npf_timestamp_t ts = at(1715934615);
+    REQUIRE(fmt("%T", &ts) == "2024-05-17T08:30:15Z");
+    ts.text[0] = 'x'; // only visible while the prefix is reused
+    ts.sec = 1715934659;
+    REQUIRE(fmt("%T", &ts) == "x024-05-17T08:30:59Z");
+    ts.sec = 1715934660;
+    REQUIRE(fmt("%T", &ts) == "2024-05-17T08:31:00Z");
+    ts.text[0] = 'x';
+    ts.sec = 1715934600;
+    REQUIRE(fmt("%T", &ts) == "2024-05-17T08:30:00Z");
+  }
+
+  SUBCASE("npf_ioprintf copies the text out of the cache") {
+    npf_timestamp_t ts = at(1715934615);
+    npf_iovec_t iov[4];
+    int iovcnt = 4;
+    char scratch[64];
+    REQUIRE(npf_ioprintf(iov, &iovcnt, scratch, sizeof(scratch), "[%T]", &ts) == 22);
+    ts.sec = 0; // reusing the cache doesn't change the segments
+    REQUIRE(fmt("%T", &ts) == "1970-01-01T00:00:00Z");
+    std::string out;
+    for (int i = 0; i < iovcnt; ++i) {
+      out.append((char const *)iov[i].iov_base, iov[i].iov_len);
+    }
+    REQUIRE(out == "[2024-05-17T08:30:15Z]");
+  }
+
+#if defined(__GLIBC__)
+  SUBCASE("matches gmtime") {
+    std::mt19937_64 rng(11);
+    npf_timestamp_t ts = {};
+    for (int i = 0; i < 20000; ++i) {
+      // Mostly nearby times, so the cache is hit and missed.
+      ts.sec = (i % 4) ? (ts.sec + (long long)(rng() % 100))
+                       : ((long long)(rng() % 200000000000ull) - 100000000000ll);
+      time_t const t = (time_t)ts.sec;
+      struct tm tm;
+      REQUIRE(gmtime_r(&t, &tm));
+      long long const year = tm.tm_year + 1900ll;
+      char expected[64];
+      snprintf(expected, sizeof(expected), "%s%04lld-%02d-%02dT%02d:%02d:%02dZ",
+               (year < 0) ? "-" : "", (year < 0) ? -year : year, tm.tm_mon + 1,
+               tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+      CAPTURE(ts.sec);
+      REQUIRE(fmt("%T", &ts) == expected);
+    }
+  }
+#endif
+}
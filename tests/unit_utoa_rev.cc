@@ -135,4 +135,15 @@ TEST_CASE("npf_utoa_rev") {
 #endif
 #endif
   }
+#if NPF_WIDE_UINT == 1
+  SUBCASE("values around the 32-bit kernel boundary") {
+    require_npf_utoa("5927694924", 0xffffffffu, 10);
+    require_npf_utoa("6927694924", 0x100000000u, 10);
+    require_npf_utoa("00000000001", 10000000000u, 10);
+    require_npf_utoa("ffffffff", 0xffffffffu, 16);
+    require_npf_utoa("000000001", 0x100000000u, 16);
+    require_npf_utoa("00000000004", 040000000000u, 8);
+    require_npf_utoa("0123456789abcdef", 0xfedcba9876543210u, 16);
+  }
+#endif
 }
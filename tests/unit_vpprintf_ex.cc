@@ -0,0 +1,90 @@
+#define NANOPRINTF_PPRINTF_EX
+#include "unit_nanoprintf.h"
+
+#include <string>
+#include <vector>
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+  #endif
+  #pragma GCC diagnostic ignored "-Wformat-zero-length"
+#endif
+
+namespace {
+struct Sink {
+  static int PutC(int c, void *ctx) {
+    Sink *s = static_cast<Sink*>(ctx);
+    ++s->calls;
+    if (s->accepted.size() >= s->capacity) { return 1; }
+    s->accepted.push_back((char)c);
+    return 0;
+  }
+
+  std::string String() const { return std::string(accepted.begin(), accepted.end()); }
+
+  size_t capacity = 1000;
+  int calls = 0;
+  std::vector<char> accepted;
+};
+}
+
+TEST_CASE("npf_vpprintf_ex") {
+  Sink s;
+
+  SUBCASE("empty string never calls callback") {
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "") == 0);
+    REQUIRE(s.calls == 0);
+  }
+
+  SUBCASE("accepting sink sees everything") {
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%s %d", "abc", -12) == 7);
+    REQUIRE(s.String() == "abc -12");
+    REQUIRE(s.calls == 7);
+  }
+
+  SUBCASE("returns accepted bytes when the sink stops") {
+    s.capacity = 3;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "abcdef") == 3);
+    REQUIRE(s.String() == "abc");
+  }
+
+  SUBCASE("sink is never called again after it stops") {
+    s.capacity = 2;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%s%s%d", "abcdef", "ghij", 12345) == 2);
+    REQUIRE(s.calls == 3);
+  }
+
+  SUBCASE("long strings and padding stop at the rejected byte") {
+    s.capacity = 2;
+    std::string const big(1000, 'x');
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%s", big.c_str()) == 2);
+    REQUIRE(s.calls == 3);
+    s.calls = 0;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%1000d", 1) == 0);
+    REQUIRE(s.calls == 1);
+    s.calls = 0;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%-1000d", 1) == 0);
+    REQUIRE(s.calls == 1);
+    s.calls = 0;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%.500d", 1) == 0);
+    REQUIRE(s.calls == 1);
+    s.calls = 0;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%.300f", 1.) == 0);
+    REQUIRE(s.calls == 1);
+  }
+
+  SUBCASE("remaining conversions are skipped") {
+    int n = -1;
+    s.capacity = 0;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "x%n", &n) == 0);
+    REQUIRE(n == -1);
+  }
+
+  SUBCASE("stopping on the final byte") {
+    s.capacity = 4;
+    REQUIRE(npf_pprintf_ex(s.PutC, &s, "%5d", 1) == 4);
+    REQUIRE(s.String() == "    ");
+  }
+}
@@ -0,0 +1,98 @@
+#define NANOPRINTF_PPRINTF_STATS
+#include "unit_nanoprintf.h"
+
+#include <cmath>
+#include <string>
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic push
+  #if NANOPRINTF_CLANG
+    #pragma GCC diagnostic ignored "-Wformat-pedantic"
+  #endif
+  #pragma GCC diagnostic ignored "-Wformat-zero-length"
+#endif
+
+namespace {
+void append(int c, void *ctx) { static_cast<std::string *>(ctx)->push_back((char)c); }
+}
+
+TEST_CASE("npf_vpprintf_stats") {
+  std::string out;
+  npf_stats_t st;
+  st.bytes = st.literal_bytes = st.converted_bytes = -1;
+  st.directives = st.max_cbuf_len = -1;
+
+  SUBCASE("empty string") {
+    REQUIRE(npf_pprintf_stats(append, &out, &st, "") == 0);
+    REQUIRE(st.bytes == 0);
+    REQUIRE(st.literal_bytes == 0);
+    REQUIRE(st.converted_bytes == 0);
+    REQUIRE(st.directives == 0);
+    REQUIRE(st.max_cbuf_len == 0);
+  }
+
+  SUBCASE("output matches npf_pprintf") {
+    REQUIRE(npf_pprintf_stats(append, &out, &st, "a%db%sc", 123, "xyz") == 9);
+    REQUIRE(out == "a123bxyzc");
+    REQUIRE(st.bytes == 9);
+  }
+
+  SUBCASE("literal and converted bytes") {
+    REQUIRE(npf_pprintf_stats(append, &out, &st, "id=%5d name=%s", 42, "bob") == 17);
+    REQUIRE(st.literal_bytes == 9);
+    REQUIRE(st.converted_bytes == 8);
+    REQUIRE(st.directives == 2);
+  }
+
+  SUBCASE("percent and writeback count as directives") {
+    int n = 0;
+    REQUIRE(npf_pprintf_stats(append, &out, &st, "100%%%n", &n) == 4);
+    REQUIRE(n == 4);
+    REQUIRE(st.directives == 2);
+    REQUIRE(st.literal_bytes == 3);
+    REQUIRE(st.converted_bytes == 1);
+  }
+
+  SUBCASE("max cbuf usage tracks the longest conversion") {
+    npf_pprintf_stats(append, &out, &st, "%d %x %o", 7, 0xabcdu, 8u);
+    REQUIRE(st.max_cbuf_len == 4);
+  }
+
+  SUBCASE("strings don't use the conversion buffer") {
+    npf_pprintf_stats(append, &out, &st, "%s", "a much longer string than the buffer");
+    REQUIRE(st.max_cbuf_len == 0);
+  }
+
+  SUBCASE("octal alt form prefix is part of the buffer") {
+    npf_pprintf_stats(append, &out, &st, "%#o", 8u);
+    REQUIRE(out == "010");
+    REQUIRE(st.max_cbuf_len == 3);
+  }
+
+  SUBCASE("floats that fit") {
+    npf_pprintf_stats(append, &out, &st, "%.3f", 12.5);
+    REQUIRE(out == "12.500");
+    REQUIRE(st.max_cbuf_len == 6);
+  }
+
+  SUBCASE("large floats stream past the conversion buffer") {
+    npf_pprintf_stats(append, &out, &st, "%F", 5e300);
+    REQUIRE(out.size() == 308);
+    REQUIRE(st.max_cbuf_len <= NANOPRINTF_CONVERSION_BUFFER_SIZE);
+  }
+
+  SUBCASE("long float precision streams past the conversion buffer") {
+    npf_pprintf_stats(append, &out, &st, "%.40F", 1.0);
+    REQUIRE(out == "1." + std::string(40, '0'));
+    REQUIRE(st.max_cbuf_len == 1);
+  }
+
+  SUBCASE("float special values") {
+    npf_pprintf_stats(append, &out, &st, "%f %F", (double)INFINITY, (double)NAN);
+    REQUIRE(out == "inf NAN");
+  }
+}
+
+#if NANOPRINTF_HAVE_GCC_WARNING_PRAGMAS
+  #pragma GCC diagnostic pop
+#endif